@@ -0,0 +1,366 @@
+//
+// Benchmarks for the generation, isomorphism, dedup and write kernels, plus
+// end-to-end level timings across thread counts.
+//
+//   bench [-n maxn] [-json] [-o results] [-baseline results.csv] [-threshold 0.10]
+//
+// Every row is (benchmark, N, maxdegree, threads, ops, ns/op); each
+// microbenchmark reports the median of BENCH_REPS runs over all unique
+// clusters of that size. Level runs check their unique counts against the
+// known values, and a run compared against a baseline fails when any row
+// got slower by more than the threshold.
+//
+
+#include "graham.h"
+#include "kernels.h"
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+#define BENCH_REPS 5
+#define BENCH_MAXROWS 1024
+#define BENCH_PAIRWISE_MAXN 7     // the pairwise engine is quadratic in the level size
+
+typedef struct {
+    char name[32];
+    int n;
+    int maxdegree;
+    int threads;
+    long ops;
+    double ns;
+} bench_row_t;
+
+static bench_row_t rows[BENCH_MAXROWS];
+static int nrows = 0;
+static long sink;     // results the timed loops must not discard
+
+static const int degrees[] = {3, 4, 6};
+
+/* Connected graphs with every degree <= maxdegree, by N; 0 where unknown.
+ * Column 0 is maxdegree >= N - 1 (no cap). */
+static const long known[][11] = {
+    {0, 0, 1, 2, 6, 21, 112, 853, 11117, 261080, 11716571},
+    {0, 0, 1, 2, 6, 10, 29, 64, 194, 531, 1733},            // maxdegree 3
+    {0, 0, 1, 2, 6, 21, 78, 353, 1929, 12207, 89402},       // maxdegree 4
+};
+
+static long known_count(int n, int maxdegree) {
+    if (n > 10) {
+        return 0;
+    }
+    if (maxdegree >= n - 1) {
+        return known[0][n];
+    }
+    return maxdegree == 3 ? known[1][n] : maxdegree == 4 ? known[2][n] : 0;
+}
+
+static void record(const char *name, int n, int maxdegree, int threads, long ops, double seconds) {
+    if (nrows == BENCH_MAXROWS) {
+        return;
+    }
+    bench_row_t *row = &rows[nrows++];
+    snprintf(row->name, sizeof(row->name), "%s", name);
+    row->n = n;
+    row->maxdegree = maxdegree;
+    row->threads = threads;
+    row->ops = ops;
+    row->ns = ops > 0 ? seconds * 1e9 / ops : 0;
+    fprintf(stderr, "%-18s N=%-3i deg=%-3i threads=%-3i %12.1f ns/op\n", name, n, maxdegree, threads, row->ns);
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *) a, y = *(const double *) b;
+    return x < y ? -1 : x > y;
+}
+
+static double median(double *times) {
+    qsort(times, BENCH_REPS, sizeof(double), compare_doubles);
+    return times[BENCH_REPS / 2];
+}
+
+/* The unique clusters of size n, copied out of the enumerator */
+static long collect_level(int n, int maxdegree, igraph_t **graphs) {
+    graham_config_t config;
+    graham_cluster_t cluster;
+    long count = 0, capacity = 0;
+
+    graham_config_init(&config);
+    config.maxn = n;
+    config.maxdegree = maxdegree;
+    config.engine = GRAHAM_ENGINE_CANONICAL;
+    graham_enumerator_t *e = graham_enumerator_create(&config);
+    *graphs = NULL;
+    while (graham_enumerator_next(e, &cluster)) {
+        if (cluster.n != n) {
+            continue;
+        }
+        if (count == capacity) {
+            capacity = capacity ? 2 * capacity : 256;
+            *graphs = realloc(*graphs, capacity * sizeof(igraph_t));
+        }
+        igraph_copy(&(*graphs)[count++], cluster.graph);
+    }
+    graham_enumerator_destroy(e);
+    return count;
+}
+
+static void graph_rows(const igraph_t *graph, uint64_t *adj) {
+    igraph_vector_t edges;
+    long n = (long) igraph_vcount(graph);
+
+    memset(adj, 0, n * sizeof(uint64_t));
+    igraph_vector_init(&edges, 0);
+    igraph_get_edgelist(graph, &edges, 0);
+    for (long e = 0; e < igraph_vector_size(&edges); e += 2) {
+        long a = (long) VECTOR(edges)[e], b = (long) VECTOR(edges)[e + 1];
+        adj[a] |= 1ULL << b;
+        adj[b] |= 1ULL << a;
+    }
+    igraph_vector_destroy(&edges);
+}
+
+static void count_child(const uint64_t *adj, int n, uint64_t mask, void *arg) {
+    ++*(long *) arg;
+}
+
+static void bench_kernels(int n, int maxdegree) {
+    igraph_t *graphs;
+    long count = collect_level(n, maxdegree, &graphs);
+    const kernel_t *kernel = kernel_select(n, maxdegree);
+    uint64_t *adj = malloc(count * n * sizeof(uint64_t));
+    uint64_t code[KERNEL_MAX_WORDS];
+    double times[BENCH_REPS], t;
+    igraph_vector_t open;
+    igraph_vector_ptr_t candidates;
+    FILE *null = fopen("/dev/null", "w");
+
+    for (long i = 0; i < count; i++) {
+        graph_rows(&graphs[i], adj + i * n);
+    }
+    igraph_vector_init(&open, 0);
+    igraph_vector_ptr_init(&candidates, 0);
+
+    for (int r = 0; r < BENCH_REPS; r++) {
+        t = omp_get_wtime();
+        for (long i = 0; i < count; i++) {
+            get_open_sites(&graphs[i], maxdegree, &open);
+        }
+        times[r] = omp_get_wtime() - t;
+    }
+    record("get_open_sites", n, maxdegree, 1, count, median(times));
+
+    for (int r = 0; r < BENCH_REPS; r++) {
+        t = omp_get_wtime();
+        for (long i = 0; i < count; i++) {
+            sink += kernel->open_sites(adj + i * n, n, maxdegree);
+        }
+        times[r] = omp_get_wtime() - t;
+    }
+    record("kernel_open_sites", n, maxdegree, 1, count, median(times));
+
+    for (int r = 0; r < BENCH_REPS; r++) {
+        t = omp_get_wtime();
+        for (long i = 0; i < count; i++) {
+            mutate_seed(&graphs[i], i, maxdegree, &candidates);
+            free_graphs_in_vector(&candidates);
+        }
+        times[r] = omp_get_wtime() - t;
+    }
+    record("mutate_seed", n, maxdegree, 1, count, median(times));
+
+    for (int r = 0; r < BENCH_REPS; r++) {
+        t = omp_get_wtime();
+        for (long i = 0; i < count; i++) {
+            kernel->expand(adj + i * n, n, maxdegree, count_child, &sink);
+        }
+        times[r] = omp_get_wtime() - t;
+    }
+    record("kernel_expand", n, maxdegree, 1, count, median(times));
+
+    // neighbouring clusters in delivery order are never isomorphic: the full test runs
+    for (int r = 0; r < BENCH_REPS; r++) {
+        t = omp_get_wtime();
+        for (long i = 0; i + 1 < count; i++) {
+            sink += isomorphic(&graphs[i], &graphs[i + 1]);
+        }
+        times[r] = omp_get_wtime() - t;
+    }
+    record("isomorphic", n, maxdegree, 1, count - 1, median(times));
+
+    for (int r = 0; r < BENCH_REPS; r++) {
+        t = omp_get_wtime();
+        for (long i = 0; i < count; i++) {
+            kernel->canonical(adj + i * n, n, code, NULL);
+        }
+        times[r] = omp_get_wtime() - t;
+    }
+    record("kernel_canonical", n, maxdegree, 1, count, median(times));
+
+    for (int r = 0; r < BENCH_REPS; r++) {
+        t = omp_get_wtime();
+        for (long i = 0; i < count; i++) {
+            write_graph(&graphs[i], null);
+        }
+        fflush(null);
+        times[r] = omp_get_wtime() - t;
+    }
+    record("write_graph", n, maxdegree, 1, count, median(times));
+
+    fclose(null);
+    igraph_vector_ptr_destroy(&candidates);
+    igraph_vector_destroy(&open);
+    for (long i = 0; i < count; i++) {
+        igraph_destroy(&graphs[i]);
+    }
+    free(graphs);
+    free(adj);
+}
+
+typedef struct {
+    const char *name;
+    int threads;
+    int maxdegree;
+    int failures;
+} level_arg_t;
+
+static void record_level(const graham_level_stats_t *stats, void *arg) {
+    level_arg_t *level = arg;
+    long expected = known_count(stats->n, level->maxdegree);
+
+    if (stats->n > 2) {
+        record(level->name, stats->n, level->maxdegree, level->threads, stats->candidates,
+               stats->generation_time + stats->filter_time);
+    }
+    if (expected != 0 && stats->unique != expected) {
+        fprintf(stderr, "%s N=%i maxdegree=%i threads=%i: %li unique clusters, expected %li\n",
+                level->name, stats->n, level->maxdegree, level->threads, stats->unique, expected);
+        level->failures++;
+    }
+}
+
+/* Whole levels through the enumerator: ns per candidate for generation plus
+ * dedup, with the unique counts checked. */
+static int bench_levels(int maxn, int maxdegree, graham_engine_t engine, int threads) {
+    graham_config_t config;
+    level_arg_t level = {engine == GRAHAM_ENGINE_PAIRWISE ? "level_pairwise" : "level_canonical",
+                         threads, maxdegree, 0};
+
+    graham_config_init(&config);
+    config.maxn = maxn;
+    config.maxdegree = maxdegree;
+    config.engine = engine;
+    config.threads = threads;
+    graham_enumerate(&config, NULL, record_level, &level);
+    return level.failures;
+}
+
+static void write_csv(FILE *out) {
+    fprintf(out, "benchmark,n,maxdegree,threads,ops,ns_per_op\n");
+    for (int i = 0; i < nrows; i++) {
+        fprintf(out, "%s,%i,%i,%i,%li,%.1f\n",
+                rows[i].name, rows[i].n, rows[i].maxdegree, rows[i].threads, rows[i].ops, rows[i].ns);
+    }
+}
+
+static void write_json(FILE *out) {
+    fprintf(out, "[\n");
+    for (int i = 0; i < nrows; i++) {
+        fprintf(out, "  {\"benchmark\": \"%s\", \"n\": %i, \"maxdegree\": %i, \"threads\": %i, "
+                     "\"ops\": %li, \"ns_per_op\": %.1f}%s\n",
+                rows[i].name, rows[i].n, rows[i].maxdegree, rows[i].threads, rows[i].ops, rows[i].ns,
+                i + 1 < nrows ? "," : "");
+    }
+    fprintf(out, "]\n");
+}
+
+/* Compares against a CSV written by an earlier run; returns the number of
+ * rows that got slower by more than threshold (a fraction). */
+static int compare_baseline(const char *path, double threshold) {
+    FILE *in = fopen(path, "r");
+    char line[256], name[32];
+    int n, maxdegree, threads, regressions = 0;
+    long ops;
+    double ns;
+
+    if (in == NULL) {
+        fprintf(stderr, "cannot open baseline %s\n", path);
+        return 1;
+    }
+    while (fgets(line, sizeof(line), in) != NULL) {
+        if (sscanf(line, "%31[^,],%i,%i,%i,%li,%lf", name, &n, &maxdegree, &threads, &ops, &ns) != 6) {
+            continue;
+        }
+        for (int i = 0; i < nrows; i++) {
+            bench_row_t *row = &rows[i];
+            if (strcmp(row->name, name) != 0 || row->n != n || row->maxdegree != maxdegree ||
+                row->threads != threads || ns <= 0) {
+                continue;
+            }
+            double change = row->ns / ns - 1;
+            if (change > threshold) {
+                printf("REGRESSION %-18s N=%-3i deg=%-3i threads=%-3i %10.1f -> %10.1f ns/op (%+.0f%%)\n",
+                       name, n, maxdegree, threads, ns, row->ns, 100 * change);
+                regressions++;
+            }
+        }
+    }
+    fclose(in);
+    return regressions;
+}
+
+int main(int argc, char **argv) {
+    int maxn = 8, json = 0, failures = 0, regressions = 0;
+    const char *output = NULL, *baseline = NULL;
+    double threshold = 0.10;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            maxn = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-json") == 0) {
+            json = 1;
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else if (strcmp(argv[i], "-baseline") == 0 && i + 1 < argc) {
+            baseline = argv[++i];
+        } else if (strcmp(argv[i], "-threshold") == 0 && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: bench [-n maxn] [-json] [-o results] "
+                            "[-baseline results.csv] [-threshold 0.10]\n");
+            return 1;
+        }
+    }
+
+    for (unsigned d = 0; d < sizeof(degrees) / sizeof(degrees[0]); d++) {
+        for (int n = 4; n <= maxn; n++) {
+            bench_kernels(n, degrees[d]);
+        }
+        failures += bench_levels(maxn < BENCH_PAIRWISE_MAXN ? maxn : BENCH_PAIRWISE_MAXN,
+                                 degrees[d], GRAHAM_ENGINE_PAIRWISE, 1);
+        for (int threads = 1; threads <= omp_get_num_procs(); threads *= 2) {
+            failures += bench_levels(maxn, degrees[d], GRAHAM_ENGINE_CANONICAL, threads);
+        }
+    }
+
+    FILE *out = output != NULL ? fopen(output, "w") : stdout;
+    if (out == NULL) {
+        fprintf(stderr, "cannot open %s\n", output);
+        return 1;
+    }
+    if (json) {
+        write_json(out);
+    } else {
+        write_csv(out);
+    }
+    if (out != stdout) {
+        fclose(out);
+    }
+    if (baseline != NULL) {
+        regressions = compare_baseline(baseline, threshold);
+    }
+    if (failures > 0) {
+        fprintf(stderr, "%i level(s) with wrong unique counts\n", failures);
+        return 2;
+    }
+    return regressions > 0 ? 3 : 0;
+}
@@ -0,0 +1,255 @@
+//
+// Indexed cluster catalog: build from nonisomorphic.txt, mmap, O(1) lookups.
+//
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "catalog.h"
+#include "graham.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+typedef struct {
+    uint64_t *codes;
+    long count;
+    long capacity;
+} code_list_t;
+
+static int sort_words;
+
+static inline uint64_t hash_code(const uint64_t *code, int words) {
+    uint64_t h = 0x9e3779b97f4a7c15ULL;
+    for (int w = 0; w < words; w++) {
+        h ^= code[w];
+        h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 31;
+    }
+    return h;
+}
+
+static int compare_codes(const void *a, const void *b) {
+    return memcmp(a, b, sort_words * sizeof(uint64_t));
+}
+
+/* Writes the canonical adjacency code of graph into code (CODE_WORDS(n) words).
+ * Two graphs are isomorphic iff their codes are equal. */
+int canonical_code(const igraph_t *graph, uint64_t *code) {
+    long n = (long) igraph_vcount(graph);
+    uint64_t rows[CATALOG_MAXN];
+    igraph_vector_t edges;
+
+    if (n > CATALOG_MAXN) {
+        IGRAPH_ERROR("Graph too large for catalog code", IGRAPH_EINVAL);
+    }
+    IGRAPH_CHECK(igraph_vector_init(&edges, 0));
+    IGRAPH_FINALLY(igraph_vector_destroy, &edges);
+    IGRAPH_CHECK(igraph_get_edgelist(graph, &edges, 0));
+
+    memset(rows, 0, n * sizeof(uint64_t));
+    for (long e = 0; e < igraph_vector_size(&edges); e += 2) {
+        long a = (long) VECTOR(edges)[e];
+        long b = (long) VECTOR(edges)[e + 1];
+        rows[a] |= 1ULL << b;
+        rows[b] |= 1ULL << a;
+    }
+    kernel_select((int) n, 0)->canonical(rows, (int) n, code, NULL);
+
+    igraph_vector_destroy(&edges);
+    IGRAPH_FINALLY_CLEAN(1);
+    return 0;
+}
+
+static void code_list_push(code_list_t *list, const uint64_t *code, int words) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? 2 * list->capacity : 1024;
+        list->codes = realloc(list->codes, list->capacity * words * sizeof(uint64_t));
+    }
+    memcpy(list->codes + list->count * words, code, words * sizeof(uint64_t));
+    list->count++;
+}
+
+/* Canonicalizes every graph in graphs_path and writes an indexed catalog. */
+int catalog_build(const char *graphs_path, const char *catalog_path) {
+    code_list_t levels[CATALOG_MAXN + 1];
+    catalog_level_t table[CATALOG_MAXN + 1];
+    uint64_t code[CATALOG_MAX_WORDS];
+    catalog_header_t header;
+    igraph_t graph;
+    uint64_t offset, total = 0;
+    int nlevels = 0;
+
+    FILE *in = fopen(graphs_path, "r");
+    if (in == NULL) {
+        IGRAPH_ERROR("Cannot open graph file", IGRAPH_EFILE);
+    }
+    memset(levels, 0, sizeof(levels));
+    while (read_graph(in, &graph) == 0) {
+        int n = (int) igraph_vcount(&graph);
+        if (canonical_code(&graph, code) == 0) {
+            code_list_push(&levels[n], code, CODE_WORDS(n));
+        }
+        igraph_destroy(&graph);
+    }
+    fclose(in);
+
+    // sort and drop repeated codes so each isomorphism class has one rank
+    for (int n = 0; n <= CATALOG_MAXN; n++) {
+        code_list_t *list = &levels[n];
+        long kept = 0;
+        if (list->count == 0) {
+            continue;
+        }
+        sort_words = CODE_WORDS(n);
+        qsort(list->codes, list->count, sort_words * sizeof(uint64_t), compare_codes);
+        for (long i = 0; i < list->count; i++) {
+            if (kept == 0 || compare_codes(list->codes + (kept - 1) * sort_words,
+                                           list->codes + i * sort_words)) {
+                memmove(list->codes + kept * sort_words, list->codes + i * sort_words,
+                        sort_words * sizeof(uint64_t));
+                kept++;
+            }
+        }
+        list->count = kept;
+
+        table[nlevels].n = n;
+        table[nlevels].words = sort_words;
+        table[nlevels].count = kept;
+        table[nlevels].first_id = total;
+        table[nlevels].index_slots = 1;
+        while (table[nlevels].index_slots < 2 * (uint64_t) kept) {
+            table[nlevels].index_slots <<= 1;
+        }
+        total += kept;
+        nlevels++;
+    }
+
+    offset = sizeof(header) + nlevels * sizeof(catalog_level_t);
+    for (int l = 0; l < nlevels; l++) {
+        table[l].codes_offset = offset;
+        offset += table[l].count * table[l].words * sizeof(uint64_t);
+        table[l].index_offset = offset;
+        offset += (table[l].index_slots * sizeof(uint32_t) + 7) & ~(uint64_t) 7;
+    }
+
+    FILE *out = fopen(catalog_path, "wb");
+    if (out == NULL) {
+        IGRAPH_ERROR("Cannot open catalog file", IGRAPH_EFILE);
+    }
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CATALOG_MAGIC, sizeof(header.magic));
+    header.version = CATALOG_VERSION;
+    header.nlevels = nlevels;
+    header.total = total;
+    fwrite(&header, sizeof(header), 1, out);
+    fwrite(table, sizeof(catalog_level_t), nlevels, out);
+
+    for (int l = 0; l < nlevels; l++) {
+        code_list_t *list = &levels[table[l].n];
+        int words = table[l].words;
+        uint64_t mask = table[l].index_slots - 1;
+        uint32_t *index = calloc(table[l].index_slots + 1, sizeof(uint32_t));
+
+        for (long i = 0; i < list->count; i++) {
+            uint64_t slot = hash_code(list->codes + i * words, words) & mask;
+            while (index[slot]) {
+                slot = (slot + 1) & mask;
+            }
+            index[slot] = (uint32_t) (i + 1);
+        }
+        fwrite(list->codes, words * sizeof(uint64_t), list->count, out);
+        fwrite(index, sizeof(uint32_t), (table[l].index_slots + 1) & ~(uint64_t) 1, out);
+        free(index);
+        free(list->codes);
+    }
+    if (fclose(out) != 0) {
+        IGRAPH_ERROR("Write error", IGRAPH_EFILE);
+    }
+    return 0;
+}
+
+int catalog_open(catalog_t *catalog, const char *path) {
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+
+    memset(catalog, 0, sizeof(*catalog));
+    if (fd < 0) {
+        IGRAPH_ERROR("Cannot open catalog file", IGRAPH_EFILE);
+    }
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(catalog_header_t)) {
+        close(fd);
+        IGRAPH_ERROR("Catalog file is truncated", IGRAPH_EFILE);
+    }
+    catalog->size = st.st_size;
+    catalog->map = mmap(NULL, catalog->size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (catalog->map == MAP_FAILED) {
+        catalog->map = NULL;
+        IGRAPH_ERROR("Cannot map catalog file", IGRAPH_EFILE);
+    }
+
+    catalog->header = catalog->map;
+    catalog->levels = (const catalog_level_t *) (catalog->header + 1);
+    if (memcmp(catalog->header->magic, CATALOG_MAGIC, 8) != 0 ||
+        catalog->header->version != CATALOG_VERSION) {
+        catalog_close(catalog);
+        IGRAPH_ERROR("Not a graham catalog", IGRAPH_PARSEERROR);
+    }
+    for (uint32_t l = 0; l < catalog->header->nlevels; l++) {
+        const catalog_level_t *level = &catalog->levels[l];
+        if (level->n <= CATALOG_MAXN) {
+            catalog->by_n[level->n] = level;
+        }
+    }
+    return 0;
+}
+
+void catalog_close(catalog_t *catalog) {
+    if (catalog->map != NULL) {
+        munmap(catalog->map, catalog->size);
+    }
+    memset(catalog, 0, sizeof(*catalog));
+}
+
+/* Returns the catalog ID of an n-vertex canonical code, or -1 if absent. */
+int64_t catalog_find_code(const catalog_t *catalog, int n, const uint64_t *code) {
+    if (n < 0 || n > CATALOG_MAXN || catalog->by_n[n] == NULL) {
+        return -1;
+    }
+    const catalog_level_t *level = catalog->by_n[n];
+    const char *base = catalog->map;
+    const uint64_t *codes = (const uint64_t *) (base + level->codes_offset);
+    const uint32_t *index = (const uint32_t *) (base + level->index_offset);
+    uint64_t mask = level->index_slots - 1;
+    uint64_t slot = hash_code(code, level->words) & mask;
+
+    while (index[slot]) {
+        uint64_t rank = index[slot] - 1;
+        if (memcmp(codes + rank * level->words, code, level->words * sizeof(uint64_t)) == 0) {
+            return (int64_t) (level->first_id + rank);
+        }
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+/* Canonicalizes graph and returns its catalog ID, or -1 if absent. */
+int64_t catalog_lookup(const catalog_t *catalog, const igraph_t *graph) {
+    uint64_t code[CATALOG_MAX_WORDS];
+    int n = (int) igraph_vcount(graph);
+
+    if (n > CATALOG_MAXN || canonical_code(graph, code) != 0) {
+        return -1;
+    }
+    return catalog_find_code(catalog, n, code);
+}
+
+void catalog_lookup_batch(const catalog_t *catalog, igraph_t **graphs, long count, int64_t *ids) {
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (long i = 0; i < count; i++) {
+        ids[i] = catalog_lookup(catalog, graphs[i]);
+    }
+}
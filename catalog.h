@@ -0,0 +1,60 @@
+//
+// Indexed cluster catalog: canonical codes per level, sorted and hashed,
+// laid out so the whole file can be mmap'ed and queried in place.
+//
+
+#ifndef GRAHAM_CATALOG_H
+#define GRAHAM_CATALOG_H
+
+#include <igraph/igraph.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "kernels.h"
+
+#define CATALOG_MAXN KERNEL_MAXN
+#define CATALOG_MAX_WORDS CODE_WORDS(CATALOG_MAXN)
+
+#define CATALOG_MAGIC "GRHMCAT1"
+#define CATALOG_VERSION 2      // 2: codes come from the bit-row kernels, not bliss
+
+/* On-disk layout (all little-endian, 8-byte aligned):
+ *   catalog_header_t
+ *   catalog_level_t[nlevels]
+ *   per level: sorted codes (count * words uint64) then the hash index
+ *   (index_slots uint32, each holding rank + 1 or 0 for an empty slot) */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t nlevels;
+    uint64_t total;
+} catalog_header_t;
+
+typedef struct {
+    uint32_t n;             // vertices per graph in this level
+    uint32_t words;         // CODE_WORDS(n)
+    uint64_t count;         // number of graphs in this level
+    uint64_t first_id;      // catalog ID of the first graph in this level
+    uint64_t codes_offset;  // byte offset of the sorted code array
+    uint64_t index_offset;  // byte offset of the hash index
+    uint64_t index_slots;   // power of two
+} catalog_level_t;
+
+typedef struct {
+    void *map;
+    size_t size;
+    const catalog_header_t *header;
+    const catalog_level_t *levels;
+    const catalog_level_t *by_n[CATALOG_MAXN + 1];
+} catalog_t;
+
+int canonical_code(const igraph_t *graph, uint64_t *code);
+
+int catalog_build(const char *graphs_path, const char *catalog_path);
+int catalog_open(catalog_t *catalog, const char *path);
+void catalog_close(catalog_t *catalog);
+
+int64_t catalog_find_code(const catalog_t *catalog, int n, const uint64_t *code);
+int64_t catalog_lookup(const catalog_t *catalog, const igraph_t *graph);
+void catalog_lookup_batch(const catalog_t *catalog, igraph_t **graphs, long count, int64_t *ids);
+
+#endif //GRAHAM_CATALOG_H
@@ -0,0 +1,99 @@
+//
+// Command line front end for the cluster catalog.
+//
+//   catalog build  <graphs.txt> <catalog.bin>
+//   catalog lookup <catalog.bin> <queries.txt>
+//   catalog info   <catalog.bin>
+//
+
+#include "catalog.h"
+#include "graham.h"
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+#define BATCH 65536
+
+static void usage(void) {
+    fprintf(stderr, "usage: catalog build <graphs.txt> <catalog.bin>\n"
+                    "       catalog lookup <catalog.bin> <queries.txt>\n"
+                    "       catalog info <catalog.bin>\n");
+}
+
+static int info(const char *path) {
+    catalog_t catalog;
+    if (catalog_open(&catalog, path) != 0) {
+        return 1;
+    }
+    printf("%10s %10s %10s\n", "N", "count", "first_id");
+    for (uint32_t l = 0; l < catalog.header->nlevels; l++) {
+        printf("%10u %10lu %10lu\n",
+               catalog.levels[l].n,
+               (unsigned long) catalog.levels[l].count,
+               (unsigned long) catalog.levels[l].first_id);
+    }
+    printf("total %lu graphs, %lu bytes\n", (unsigned long) catalog.header->total, (unsigned long) catalog.size);
+    catalog_close(&catalog);
+    return 0;
+}
+
+/* Prints one catalog ID per query graph (-1 when absent), in input order. */
+static int lookup(const char *catalog_path, const char *query_path) {
+    catalog_t catalog;
+    igraph_t **graphs;
+    int64_t *ids;
+    long count, total = 0;
+    double start, elapsed = 0;
+
+    FILE *in = fopen(query_path, "r");
+    if (in == NULL) {
+        fprintf(stderr, "cannot open %s\n", query_path);
+        return 1;
+    }
+    if (catalog_open(&catalog, catalog_path) != 0) {
+        fclose(in);
+        return 1;
+    }
+    graphs = calloc(BATCH, sizeof(igraph_t *));
+    ids = calloc(BATCH, sizeof(int64_t));
+    do {
+        for (count = 0; count < BATCH; count++) {
+            graphs[count] = igraph_Calloc(1, igraph_t);
+            if (read_graph(in, graphs[count]) != 0) {
+                free(graphs[count]);
+                break;
+            }
+        }
+        start = omp_get_wtime();
+        catalog_lookup_batch(&catalog, graphs, count, ids);
+        elapsed += omp_get_wtime() - start;
+        for (long i = 0; i < count; i++) {
+            printf("%lld\n", (long long) ids[i]);
+            igraph_destroy(graphs[i]);
+            free(graphs[i]);
+        }
+        total += count;
+    } while (count == BATCH);
+
+    fprintf(stderr, "%li queries in %.4f s (%.3f us/query)\n",
+            total, elapsed, total ? 1e6 * elapsed / total : 0.0);
+    free(graphs);
+    free(ids);
+    fclose(in);
+    catalog_close(&catalog);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 4 && strcmp(argv[1], "build") == 0) {
+        return catalog_build(argv[2], argv[3]) != 0;
+    }
+    if (argc == 4 && strcmp(argv[1], "lookup") == 0) {
+        return lookup(argv[2], argv[3]);
+    }
+    if (argc == 3 && strcmp(argv[1], "info") == 0) {
+        return info(argv[2]);
+    }
+    usage();
+    return 2;
+}
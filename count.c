@@ -0,0 +1,604 @@
+//
+// Counting-only enumeration: canonical augmentation depth-first search that
+// keeps per-thread counters and never stores or builds a graph.
+//
+
+#include "graham.h"
+#include "kernels.h"
+#include "trace.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+// levels below maxn - COUNT_TASK_LEVELS hand their children out as tasks
+#define COUNT_TASK_LEVELS 3
+
+// graham_estimate: largest level expanded exactly before sampling starts
+#define ESTIMATE_MAX_NODES 8192
+
+// graham_sample: paths per parallel block, and paths measuring the mean weight
+#define SAMPLE_BLOCK 256
+#define SAMPLE_PILOT 1024
+
+typedef struct {
+    long by_n[GRAHAM_MAXN + 1];
+    long by_degree[GRAHAM_MAXN + 1][GRAHAM_MAXN + 1];
+    long *by_edges;
+    graham_fates_t fates[GRAHAM_MAXN + 1];
+    char pad[64];
+} count_thread_t;
+
+typedef struct {
+    const graham_config_t *config;
+    const kernel_t *kernel;
+    int maxedges;
+    count_thread_t *threads;
+} count_state_t;
+
+typedef struct {
+    uint64_t *masks;
+    long count;
+    long capacity;
+} mask_list_t;
+
+static void collect_mask(const uint64_t *rows, int n, uint64_t mask, void *arg) {
+    mask_list_t *list = arg;
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? 2 * list->capacity : 64;
+        list->masks = realloc(list->masks, list->capacity * sizeof(uint64_t));
+    }
+    list->masks[list->count++] = mask;
+}
+
+/* True if the graph stays connected when vertex u is removed */
+static int connected_without(const uint64_t *rows, int n, int u) {
+    uint64_t all = (n == 64 ? ~0ULL : (1ULL << n) - 1) & ~(1ULL << u);
+    uint64_t reached = all & -all, frontier = reached;
+
+    while (frontier) {
+        uint64_t next = 0;
+        for (uint64_t m = frontier; m; m &= m - 1) {
+            next |= rows[__builtin_ctzll(m)];
+        }
+        frontier = next & all & ~reached;
+        reached |= frontier;
+    }
+    return reached == all;
+}
+
+static long find_root(long *up, long i) {
+    while (up[i] != i) {
+        i = up[i] = up[up[i]];
+    }
+    return i;
+}
+
+/* Keeps one mask per orbit of the seed's automorphism group (the first one
+ * in generation order) and returns how many remain at the front of list. */
+static long mask_orbit_representatives(mask_list_t *list, const kernel_seed_t *seed) {
+    long slots = 1, kept = 0;
+    if (seed->ngens == 0) {
+        return list->count;
+    }
+    while (slots < 2 * list->count) {
+        slots <<= 1;
+    }
+    long *table = malloc(slots * sizeof(long));
+    long *up = malloc(list->count * sizeof(long));
+    memset(table, 0xff, slots * sizeof(long));
+    for (long i = 0; i < list->count; i++) {
+        long slot = (long) ((list->masks[i] * 0x9e3779b97f4a7c15ULL) >> 32) & (slots - 1);
+        while (table[slot] >= 0) {
+            slot = (slot + 1) & (slots - 1);
+        }
+        table[slot] = i;
+        up[i] = i;
+    }
+    for (int g = 0; g < seed->ngens; g++) {
+        const unsigned char *gen = KERNEL_SEED_GEN(seed, g);
+        for (long i = 0; i < list->count; i++) {
+            uint64_t image = 0;
+            for (uint64_t m = list->masks[i]; m; m &= m - 1) {
+                image |= 1ULL << gen[__builtin_ctzll(m)];
+            }
+            long slot = (long) ((image * 0x9e3779b97f4a7c15ULL) >> 32) & (slots - 1);
+            while (list->masks[table[slot]] != image) {
+                slot = (slot + 1) & (slots - 1);
+            }
+            long a = find_root(up, i), b = find_root(up, table[slot]);
+            if (a != b) {
+                up[a > b ? a : b] = a < b ? a : b;
+            }
+        }
+    }
+    for (long i = 0; i < list->count; i++) {
+        if (find_root(up, i) == i) {
+            list->masks[kept++] = list->masks[i];
+        }
+    }
+    free(up);
+    free(table);
+    return kept;
+}
+
+/* Canonicalizes the graph grown from parent by a vertex attached to mask
+ * (the root edge when parent is NULL), filling seed when it is not NULL.
+ * True if the new vertex is in the orbit of the canonical deletion vertex:
+ * among the non-cut vertices of least degree, the one with the largest
+ * canonical label. Together with one mask per orbit of the parent's
+ * automorphisms, this reaches every isomorphism class exactly once.
+ * Preferring low degree keeps the tree balanced (a new leaf always
+ * qualifies) and settles most children from degrees alone. */
+static int canonical_child(const kernel_t *kernel, const uint64_t *rows, int n,
+                           const kernel_seed_t *parent, uint64_t mask, kernel_seed_t *seed) {
+    uint64_t code[KERNEL_MAX_WORDS];
+    int labeling[KERNEL_MAXN], orbit[KERNEL_MAXN], vertex[KERNEL_MAXN];
+    int degree = __builtin_popcountll(mask), ties = 0, last = -1;
+
+    for (int v = 0; parent != NULL && v < n - 1; v++) {
+        int d = __builtin_popcountll(rows[v]);
+        if (d <= degree && connected_without(rows, n, v)) {
+            if (d < degree) {
+                return 0;
+            }
+            ties++;
+        }
+    }
+    if (parent != NULL && ties == 0 && seed == NULL) {
+        return 1;
+    }
+    kernel->canonical_seeded(rows, n, parent, mask, code, labeling, orbit, seed);
+    if (parent == NULL || ties == 0) {
+        return 1;
+    }
+    for (int v = 0; v < n; v++) {
+        vertex[labeling[v]] = v;
+    }
+    for (int l = n - 1; l >= 0 && last < 0; l--) {
+        int v = vertex[l];
+        if (__builtin_popcountll(rows[v]) == degree && connected_without(rows, n, v)) {
+            last = v;
+        }
+    }
+    return orbit[n - 1] == orbit[last];
+}
+
+/* Grows (rows, n) by one vertex attached to mask into child */
+static void attach(uint64_t *child, const uint64_t *rows, int n, uint64_t mask) {
+    memcpy(child, rows, n * sizeof(uint64_t));
+    child[n] = mask;
+    for (uint64_t m = mask; m; m &= m - 1) {
+        child[__builtin_ctzll(m)] |= 1ULL << n;
+    }
+}
+
+/* Counts and expands the graph grown from parent by mask if it is the
+ * canonical child (see canonical_child). */
+static void visit(count_state_t *st, const uint64_t *rows, int n, const kernel_seed_t *parent,
+                  uint64_t mask, int edges) {
+    const graham_config_t *config = st->config;
+    kernel_seed_t *seed = NULL;
+    count_thread_t *counts = &st->threads[omp_get_thread_num()];
+
+    if (n < config->maxn) {
+        seed = malloc(KERNEL_SEED_SIZE(n, KERNEL_MAX_GENS));
+        seed->capacity = KERNEL_MAX_GENS;
+    }
+    if (!canonical_child(st->kernel, rows, n, parent, mask, seed)) {
+        counts->fates[n].canonical_rejected++;
+        free(seed);
+        return;
+    }
+
+    int maxdegree = 0;
+    for (int v = 0; v < n; v++) {
+        int degree = __builtin_popcountll(rows[v]);
+        maxdegree = degree > maxdegree ? degree : maxdegree;
+    }
+    counts->by_n[n]++;
+    counts->fates[n].accepted++;
+    counts->by_degree[n][maxdegree]++;
+    counts->by_edges[n * (st->maxedges + 1) + edges]++;
+    if (seed == NULL) {
+        return;
+    }
+
+    mask_list_t list = {NULL, 0, 0};
+    st->kernel->expand(rows, n, config->maxdegree, collect_mask, &list);
+    long children = mask_orbit_representatives(&list, seed);
+    graham_fates_t *fates = &counts->fates[n + 1];
+    fates->subsets += list.count;
+    fates->orbit_pruned += list.count - children;
+    fates->children += children;
+    fates->seed_children[graham_hist_bin(children)]++;
+    int spawn = n < config->maxn - COUNT_TASK_LEVELS;
+
+    for (long i = 0; i < children; i++) {
+        uint64_t child_mask = list.masks[i];
+        uint64_t *child = malloc((n + 1) * sizeof(uint64_t));
+        attach(child, rows, n, child_mask);
+        int child_edges = edges + __builtin_popcountll(child_mask);
+        if (spawn) {
+            #pragma omp task firstprivate(child, child_mask, child_edges)
+            {
+                double span = trace_now();
+                visit(st, child, n + 1, seed, child_mask, child_edges);
+                trace_span("subtree", n + 1, span);
+                free(child);
+            }
+        } else {
+            visit(st, child, n + 1, seed, child_mask, child_edges);
+            free(child);
+        }
+    }
+    if (spawn) {
+        #pragma omp taskwait
+    }
+    free(list.masks);
+    free(seed);
+}
+
+/* Counts the clusters of every size up to config->maxn without materializing
+ * them. Only config->engine is ignored. */
+int graham_count(const graham_config_t *config, graham_counts_t *counts) {
+    count_state_t st;
+    int nthreads;
+    uint64_t root[2] = {2, 1};
+    double start = omp_get_wtime();
+
+    IGRAPH_CHECK(graham_config_check(config));
+    if (config->threads > 0) {
+        omp_set_num_threads(config->threads);
+    }
+    nthreads = omp_get_max_threads();
+    memset(counts, 0, sizeof(*counts));
+    counts->maxn = config->maxn;
+    int degree_cap = config->maxdegree < config->maxn - 1 ? config->maxdegree : config->maxn - 1;
+    counts->maxedges = config->maxn * degree_cap / 2;
+
+    st.config = config;
+    st.kernel = kernel_select(config->maxn, config->maxdegree);
+    st.maxedges = counts->maxedges;
+    st.threads = calloc(nthreads, sizeof(count_thread_t));
+    for (int t = 0; t < nthreads; t++) {
+        st.threads[t].by_edges = calloc((config->maxn + 1) * (st.maxedges + 1), sizeof(long));
+    }
+    st.threads[0].fates[2].subsets = 1;
+    st.threads[0].fates[2].children = 1;
+
+    #pragma omp parallel
+    {
+        #pragma omp single
+        visit(&st, root, 2, NULL, 1, 1);
+    }
+
+    counts->by_edges = calloc((config->maxn + 1) * (st.maxedges + 1), sizeof(long));
+    for (int t = 0; t < nthreads; t++) {
+        count_thread_t *thread = &st.threads[t];
+        for (int n = 0; n <= config->maxn; n++) {
+            counts->by_n[n] += thread->by_n[n];
+            graham_fates_add(&counts->fates[n], &thread->fates[n]);
+            for (int d = 0; d <= n; d++) {
+                counts->by_degree[n][d] += thread->by_degree[n][d];
+            }
+        }
+        for (long i = 0; i < (config->maxn + 1) * (st.maxedges + 1); i++) {
+            counts->by_edges[i] += thread->by_edges[i];
+        }
+        free(thread->by_edges);
+    }
+    free(st.threads);
+    counts->time = omp_get_wtime() - start;
+    return 0;
+}
+
+static uint64_t next_random(uint64_t *state) {
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/* A node of the augmentation tree where random paths start */
+typedef struct {
+    int n, edges;
+    uint64_t rows[KERNEL_MAXN];
+    kernel_seed_t *seed;        // metadata for expanding the node
+} estimate_node_t;
+
+/* Leaves the masks of the canonical children of (rows, n) at the front of
+ * list and returns their number; *subsets is set to the enumerator's
+ * candidate count for the node. */
+static long canonical_children(const graham_config_t *config, const kernel_t *kernel, const uint64_t *rows,
+                               int n, const kernel_seed_t *seed, mask_list_t *list, long *subsets) {
+    uint64_t child[KERNEL_MAXN];
+    long kept = 0;
+
+    list->count = 0;
+    kernel->expand(rows, n, config->maxdegree, collect_mask, list);
+    *subsets = list->count;
+    long children = mask_orbit_representatives(list, seed);
+    for (long i = 0; i < children; i++) {
+        attach(child, rows, n, list->masks[i]);
+        if (canonical_child(kernel, child, n + 1, seed, list->masks[i], NULL)) {
+            list->masks[kept++] = list->masks[i];
+        }
+    }
+    return kept;
+}
+
+/* One random path from start down the augmentation tree (Knuth's
+ * estimator): at every node one canonical child is followed, and weight
+ * times the product of their numbers so far estimates the clusters at that
+ * depth; weight times the node's subsets estimates the next level's
+ * candidates. sums, if not NULL, gets per n the sum and sum of squares of
+ * both estimates and the weighted edge count. Returns the weight at
+ * config->maxn, with the cluster reached there in leaf (if not NULL), or 0
+ * when the path ends early. */
+static double probe(const graham_config_t *config, const kernel_t *kernel, const estimate_node_t *start,
+                    double weight, uint64_t *state, double (*sums)[5], uint64_t *leaf) {
+    uint64_t rows[KERNEL_MAXN], child[KERNEL_MAXN];
+    size_t size = KERNEL_SEED_SIZE(config->maxn, KERNEL_MAX_GENS);
+    kernel_seed_t *own = malloc(size), *next = malloc(size);
+    const kernel_seed_t *seed = start->seed;
+    mask_list_t list = {NULL, 0, 0};
+    int edges = start->edges;
+
+    memcpy(rows, start->rows, start->n * sizeof(uint64_t));
+    for (int n = start->n; ; n++) {
+        long subsets;
+        if (sums != NULL) {
+            sums[n][0] += weight;
+            sums[n][1] += weight * weight;
+            sums[n][4] += weight * edges;
+        }
+        if (n == config->maxn) {
+            if (leaf != NULL) {
+                memcpy(leaf, rows, n * sizeof(uint64_t));
+            }
+            break;
+        }
+        long kept = canonical_children(config, kernel, rows, n, seed, &list, &subsets);
+        if (sums != NULL) {
+            sums[n + 1][2] += weight * subsets;
+            sums[n + 1][3] += weight * subsets * weight * subsets;
+        }
+        if (kept == 0) {
+            weight = 0;
+            break;
+        }
+        uint64_t mask = list.masks[next_random(state) % kept];
+        attach(child, rows, n, mask);
+        if (n + 1 < config->maxn) {
+            next->capacity = KERNEL_MAX_GENS;
+            canonical_child(kernel, child, n + 1, seed, mask, next);
+            kernel_seed_t *swap = own;
+            own = next;
+            next = swap;
+            seed = own;
+        }
+        memcpy(rows, child, (n + 1) * sizeof(uint64_t));
+        edges += __builtin_popcountll(mask);
+        weight *= kept;
+    }
+    free(list.masks);
+    free(own);
+    free(next);
+    return weight;
+}
+
+static void free_nodes(estimate_node_t *level, long nodes) {
+    for (long i = 0; i < nodes; i++) {
+        free(level[i].seed);
+    }
+    free(level);
+}
+
+/* Expands the augmentation tree level by level while a level has at most
+ * ESTIMATE_MAX_NODES nodes, recording the exact counts in estimate, and
+ * returns the nodes of the last level expanded (*nodes of them). */
+static estimate_node_t *exact_levels(const graham_config_t *config, const kernel_t *kernel,
+                                     graham_estimate_t *estimate, long *nodes) {
+    size_t size = KERNEL_SEED_SIZE(config->maxn, KERNEL_MAX_GENS);
+    mask_list_t list = {NULL, 0, 0};
+    estimate_node_t *level = calloc(1, sizeof(estimate_node_t));
+
+    memset(estimate, 0, sizeof(*estimate));
+    estimate->maxn = config->maxn;
+    *nodes = 1;
+    level->n = 2;
+    level->edges = 1;
+    level->rows[0] = 2;
+    level->rows[1] = 1;
+    level->seed = malloc(size);
+    level->seed->capacity = KERNEL_MAX_GENS;
+    kernel->canonical_seeded(level->rows, 2, NULL, 1, (uint64_t[KERNEL_MAX_WORDS]) {0}, NULL, NULL, level->seed);
+    estimate->unique[2] = estimate->candidates[2] = 1;
+    estimate->edges[2] = 1;
+    estimate->exact = 2;
+    while (estimate->exact < config->maxn) {
+        int n = estimate->exact;
+        long count = 0, capacity = 0, candidates = 0, edges = 0;
+        estimate_node_t *children = NULL;
+        for (long i = 0; i < *nodes && count <= ESTIMATE_MAX_NODES; i++) {
+            long subsets, kept = canonical_children(config, kernel, level[i].rows, n, level[i].seed, &list, &subsets);
+            candidates += subsets;
+            for (long k = 0; k < kept; k++) {
+                if (count == capacity) {
+                    capacity = capacity ? 2 * capacity : 64;
+                    children = realloc(children, capacity * sizeof(estimate_node_t));
+                }
+                estimate_node_t *c = &children[count++];
+                c->n = n + 1;
+                c->edges = level[i].edges + __builtin_popcountll(list.masks[k]);
+                attach(c->rows, level[i].rows, n, list.masks[k]);
+                c->seed = malloc(size);
+                c->seed->capacity = KERNEL_MAX_GENS;
+                canonical_child(kernel, c->rows, n + 1, level[i].seed, list.masks[k], c->seed);
+                edges += c->edges;
+            }
+        }
+        if (count > ESTIMATE_MAX_NODES) {
+            free_nodes(children, count);
+            break;
+        }
+        free_nodes(level, *nodes);
+        level = children;
+        *nodes = count;
+        estimate->exact = n + 1;
+        estimate->unique[n + 1] = count;
+        estimate->candidates[n + 1] = candidates;
+        estimate->edges[n + 1] = count ? (double) edges / count : 0;
+        if (count == 0) {
+            break;
+        }
+    }
+    free(list.masks);
+    return level;
+}
+
+/* Estimates the clusters and enumerator candidates of every size up to
+ * config->maxn, in a fraction of the time an exact count takes. The tree is
+ * expanded exactly while a level has at most ESTIMATE_MAX_NODES nodes;
+ * probes random paths, seeded by random_seed, then start from uniformly
+ * chosen nodes of the last exact level. Exact levels have a standard error
+ * of 0; the others shrink as 1 / sqrt(probes). */
+int graham_estimate(const graham_config_t *config, long probes, uint64_t random_seed,
+                    graham_estimate_t *estimate) {
+    double start = omp_get_wtime();
+
+    IGRAPH_CHECK(graham_config_check(config));
+    if (probes < 2) {
+        IGRAPH_ERROR("at least two probes are needed for an error estimate", IGRAPH_EINVAL);
+    }
+    if (config->threads > 0) {
+        omp_set_num_threads(config->threads);
+    }
+    const kernel_t *kernel = kernel_select(config->maxn, config->maxdegree);
+    long nodes;
+    estimate_node_t *level = exact_levels(config, kernel, estimate, &nodes);
+    int exact = estimate->exact;
+
+    // random paths from the last exact level
+    double (*sums)[5] = calloc(config->maxn + 1, sizeof(*sums));
+    if (exact < config->maxn && nodes > 0) {
+        estimate->probes = probes;
+        #pragma omp parallel
+        {
+            double (*local)[5] = calloc(config->maxn + 1, sizeof(*local));
+            #pragma omp for schedule(dynamic)
+            for (long p = 0; p < probes; p++) {
+                uint64_t state = random_seed ^ (uint64_t) p * 0xd1b54a32d192ed03ULL;
+                probe(config, kernel, &level[next_random(&state) % nodes], nodes, &state, local, NULL);
+            }
+            #pragma omp critical
+            for (int n = 0; n <= config->maxn; n++) {
+                for (int k = 0; k < 5; k++) {
+                    sums[n][k] += local[n][k];
+                }
+            }
+            free(local);
+        }
+    }
+    for (int n = exact + 1; estimate->probes > 0 && n <= config->maxn; n++) {
+        double mean = sums[n][0] / probes, candidates = sums[n][2] / probes;
+        estimate->unique[n] = mean;
+        estimate->unique_se[n] = sqrt(fmax(sums[n][1] / probes - mean * mean, 0) / (probes - 1));
+        estimate->candidates[n] = candidates;
+        estimate->candidates_se[n] = sqrt(fmax(sums[n][3] / probes - candidates * candidates, 0) / (probes - 1));
+        estimate->edges[n] = sums[n][0] > 0 ? sums[n][4] / sums[n][0] : 0;
+    }
+    free_nodes(level, nodes);
+    free(sums);
+    estimate->time = omp_get_wtime() - start;
+    return 0;
+}
+
+/* Builds the igraph_t of a cluster held as adjacency rows */
+static void rows_graph(const uint64_t *rows, int n, igraph_t *graph) {
+    igraph_vector_t edges;
+
+    igraph_vector_init(&edges, 0);
+    for (int v = 1; v < n; v++) {
+        for (uint64_t m = rows[v] & ((1ULL << v) - 1); m; m &= m - 1) {
+            igraph_vector_push_back(&edges, (igraph_real_t) __builtin_ctzll(m));
+            igraph_vector_push_back(&edges, (igraph_real_t) v);
+        }
+    }
+    igraph_create(graph, &edges, n, IGRAPH_UNDIRECTED);
+    igraph_vector_destroy(&edges);
+}
+
+/* Draws samples clusters of size config->maxn uniformly at random from
+ * the isomorphism classes, handing each to on_cluster (parent is -1, mask
+ * the last vertex's attachment; returning nonzero stops). Every random path
+ * of weight w (see probe) is delivered w / bound times, rounded up or down
+ * at random, where bound is oversample times the mean weight from a pilot
+ * run: each class then arrives 1 / bound times per path in expectation.
+ * Paths heavier than bound repeat their cluster (stats->repeated); with a
+ * large enough oversample none do and the draws are independent, at the
+ * cost of more paths per sample. The same random_seed gives the same
+ * samples for any number of threads. */
+int graham_sample(const graham_config_t *config, long samples, uint64_t random_seed, double oversample,
+                  graham_cluster_callback_t *on_cluster, void *arg, graham_sample_stats_t *stats) {
+    graham_estimate_t estimate;
+    double start = omp_get_wtime(), pilot = 0;
+    long nodes, copies[SAMPLE_BLOCK];
+    int n = config->maxn, stop = 0;
+
+    IGRAPH_CHECK(graham_config_check(config));
+    if (samples < 0 || oversample <= 0) {
+        IGRAPH_ERROR("samples must not be negative and oversample must be positive", IGRAPH_EINVAL);
+    }
+    if (config->threads > 0) {
+        omp_set_num_threads(config->threads);
+    }
+    memset(stats, 0, sizeof(*stats));
+    const kernel_t *kernel = kernel_select(config->maxn, config->maxdegree);
+    estimate_node_t *level = exact_levels(config, kernel, &estimate, &nodes);
+
+    #pragma omp parallel for schedule(dynamic) reduction(+:pilot) if (nodes > 0)
+    for (long p = 0; p < (nodes > 0 ? SAMPLE_PILOT : 0); p++) {
+        uint64_t state = ~random_seed ^ (uint64_t) p * 0xd1b54a32d192ed03ULL;
+        pilot += probe(config, kernel, &level[next_random(&state) % nodes], nodes, &state, NULL, NULL);
+    }
+    stats->bound = oversample * pilot / SAMPLE_PILOT;
+
+    uint64_t (*leaves)[KERNEL_MAXN] = malloc(SAMPLE_BLOCK * sizeof(*leaves));
+    for (long block = 0; stats->bound > 0 && !stop && stats->samples < samples; block += SAMPLE_BLOCK) {
+        #pragma omp parallel for schedule(dynamic)
+        for (long i = 0; i < SAMPLE_BLOCK; i++) {
+            uint64_t state = random_seed ^ (uint64_t) (block + i) * 0xd1b54a32d192ed03ULL;
+            double share = probe(config, kernel, &level[next_random(&state) % nodes], nodes, &state, NULL,
+                                 leaves[i]) / stats->bound;
+            copies[i] = (long) share + ((next_random(&state) >> 11) * 0x1.0p-53 < share - floor(share));
+        }
+        stats->probes += SAMPLE_BLOCK;
+
+        // delivered in path order, so the output does not depend on the schedule
+        for (long i = 0; i < SAMPLE_BLOCK && !stop && stats->samples < samples; i++) {
+            igraph_t graph;
+            graham_cluster_t cluster = {n, 0, -1, leaves[i][n - 1], &graph};
+            if (copies[i] == 0) {
+                continue;
+            }
+            rows_graph(leaves[i], n, &graph);
+            for (long c = 0; c < copies[i] && !stop && stats->samples < samples; c++) {
+                cluster.id = stats->samples++;
+                stats->repeated += c > 0;
+                stop = on_cluster != NULL && on_cluster(&cluster, arg) != 0;
+            }
+            igraph_destroy(&graph);
+        }
+    }
+    free(leaves);
+    free_nodes(level, nodes);
+    stats->time = omp_get_wtime() - start;
+    return 0;
+}
+
+void graham_counts_free(graham_counts_t *counts) {
+    free(counts->by_edges);
+    counts->by_edges = NULL;
+}
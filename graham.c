@@ -0,0 +1,743 @@
+//
+// Created by John Dagdelen on 4/28/19.
+//
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "graham.h"
+#include "catalog.h"
+#include "kernels.h"
+#include "trace.h"
+#include <gsl/gsl_combination.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+#define max(x, y) ((x) >= (y)) ? (x) : (y)
+#define min(x, y) ((x) <= (y)) ? (x) : (y)
+#define true 1
+#define false 0
+
+/* A generated graph plus the (parent, attachment mask) pair it was built from.
+ * The enumerator allocates room for n adjacency rows after the struct; graph
+ * is only built when the engine or a caller needs it (has_graph). */
+typedef struct {
+    igraph_t graph;     // must stay first: a cluster_t* is used as an igraph_t*
+    int has_graph;
+    long parent;        // index of the seed in the previous level's unique list
+    uint64_t mask;      // bit v set when the new vertex is attached to seed vertex v
+    kernel_seed_t *seed;    // canonical engine: metadata its children start from
+    uint64_t rows[];    // bit u of rows[v] set iff u-v is an edge
+} cluster_t;
+
+struct graham_enumerator {
+    graham_config_t config;
+    const kernel_t *kernel;
+    int n;                          // size of the clusters held in unique
+    igraph_vector_ptr_t unique;
+    igraph_vector_ptr_t seeds;      // previous level, kept until its children are filtered
+    igraph_vector_ptr_t candidates;
+    long next;                      // graham_enumerator_next position in unique
+    double start;
+    double callback_time;
+    graham_cluster_callback_t *on_cluster;
+    void *arg;
+    int stopped;
+    long total;
+    graham_level_stats_t stats;
+    perf_counters_t perf;
+    perf_sample_t *perf_begin;      // per thread, at the start of the current phase
+    perf_sample_t *perf_threads;    // [phase * perf.nthreads + thread] for the current level
+};
+
+/* destroys a list of igraph_t objects */
+void free_graphs_in_vector(igraph_vector_ptr_t *graphlist) {
+    long int i;
+    for (i = 0; i < igraph_vector_ptr_size(graphlist); i++) {
+        igraph_destroy(VECTOR(*graphlist)[i]);
+        free(VECTOR(*graphlist)[i]);
+    }
+    igraph_vector_ptr_clear(graphlist);
+}
+
+// Returns the "available" sites for a new vertex to be connected to
+// (sites are available if they have fewer than maxdegree neighbors)
+void get_open_sites(const igraph_t *seed, int maxdegree, igraph_vector_t *open) {
+    igraph_vector_clear(open);
+    igraph_vector_t degrees;
+    igraph_vector_init(&degrees, igraph_vcount(seed));
+    igraph_degree(seed, &degrees, igraph_vss_all(), IGRAPH_ALL, 0);
+    for (int i = 0; i < igraph_vcount(seed); i++) {
+        if (VECTOR(degrees)[i] < maxdegree)
+            igraph_vector_push_back(open, i);
+    }
+    igraph_vector_destroy(&degrees);
+}
+
+void print_vertices(const igraph_t *graph) {
+    igraph_vs_t vs;
+    igraph_vit_t vit;
+    igraph_vs_seq(&vs, 0, igraph_vcount(graph));
+    igraph_vit_create(graph, vs, &vit);
+    while (!IGRAPH_VIT_END(vit)) {
+        printf(" %li", (long int) IGRAPH_VIT_GET(vit));
+        IGRAPH_VIT_NEXT(vit);
+    }
+    printf("\n");
+    igraph_vit_destroy(&vit);
+    igraph_vs_destroy(&vs);
+}
+
+/* Returns true if two graphs are isomorphic, otherwise returns false */
+igraph_bool_t isomorphic(const igraph_t *g1, const igraph_t *g2) {
+    igraph_bool_t iso;
+    igraph_isomorphic_bliss(g1, g2, &iso, NULL, NULL, IGRAPH_BLISS_F, IGRAPH_BLISS_F, NULL, NULL);
+    return iso;
+}
+
+void mutate_seed(const igraph_t *seed, long parent, int maxdegree, igraph_vector_ptr_t *candidates) {
+    // gets all combinations of up to maxdegree open vertices to connect new vertex to
+    // and creates a new graph for each case.
+    gsl_combination *c;
+    igraph_vector_t open_sites;
+    igraph_vector_init(&open_sites, igraph_vcount(seed));
+    cluster_t *candidate;
+    get_open_sites(seed, maxdegree, &open_sites);
+    int n = igraph_vector_size(&open_sites);
+    long new_vertex = (long) igraph_vcount(seed);
+    if (n > 0) {
+        int m = min(n, maxdegree);
+        for (int i = 1; i <= m; i++) {
+            c = gsl_combination_calloc(n, i);
+            do {
+                int combo_length = gsl_combination_k(c);
+                igraph_vector_t edge_list;
+                igraph_vector_init(&edge_list, combo_length * 2);
+                igraph_vector_clear(&edge_list);
+                candidate = igraph_Calloc(1, cluster_t);
+                candidate->has_graph = true;
+                candidate->parent = parent;
+                for (int j = 0; j < combo_length; j++) {
+                    // combinations index into open_sites, not into the seed's vertices
+                    long site = (long) VECTOR(open_sites)[gsl_combination_get(c, j)];
+                    igraph_vector_push_back(&edge_list, (igraph_real_t) site);
+                    igraph_vector_push_back(&edge_list, (igraph_real_t) new_vertex);
+                    candidate->mask |= 1ULL << site;
+                }
+                igraph_copy(&candidate->graph, seed);
+                igraph_add_vertices(&candidate->graph, 1, 0);
+                igraph_add_edges(&candidate->graph, &edge_list, 0);
+                igraph_vector_destroy(&edge_list);
+                igraph_vector_ptr_push_back(candidates, candidate);
+            } while (gsl_combination_next(c) == GSL_SUCCESS);
+            gsl_combination_free(c);
+        }
+    }
+    igraph_vector_destroy(&open_sites);
+}
+
+int write_graph(const igraph_t *graph, FILE *outstream) {
+
+    igraph_eit_t it;
+
+    IGRAPH_CHECK(igraph_eit_create(graph, igraph_ess_all(IGRAPH_EDGEORDER_FROM),
+                                   &it));
+    IGRAPH_FINALLY(igraph_eit_destroy, &it);
+
+    fprintf(outstream, "\n");
+
+    while (!IGRAPH_EIT_END(it)) {
+        igraph_integer_t from, to;
+        int ret;
+        igraph_edge(graph, IGRAPH_EIT_GET(it), &from, &to);
+        ret = fprintf(outstream, "%li %li ",
+                      (long int) from,
+                      (long int) to);
+        if (ret < 0) {
+            IGRAPH_ERROR("Write error", IGRAPH_EFILE);
+        }
+        IGRAPH_EIT_NEXT(it);
+    }
+    igraph_eit_destroy(&it);
+    IGRAPH_FINALLY_CLEAN(1);
+    return 0;
+}
+
+/* Reads the next graph written by write_graph ("a b a b ..." on one line).
+ * Blank lines are skipped. Returns 0 on success and EOF when input is exhausted. */
+int read_graph(FILE *instream, igraph_t *graph) {
+    char *line = NULL;
+    size_t length = 0;
+    igraph_vector_t edges;
+
+    while (getline(&line, &length, instream) != -1) {
+        char *p = line, *end;
+        IGRAPH_CHECK(igraph_vector_init(&edges, 0));
+        for (long v = strtol(p, &end, 10); end != p; v = strtol(p, &end, 10)) {
+            igraph_vector_push_back(&edges, (igraph_real_t) v);
+            p = end;
+        }
+        if (igraph_vector_size(&edges) == 0) {
+            igraph_vector_destroy(&edges);
+            continue;
+        }
+        free(line);
+        if (igraph_vector_size(&edges) % 2) {
+            igraph_vector_destroy(&edges);
+            IGRAPH_ERROR("Odd number of vertex ids in edge list", IGRAPH_PARSEERROR);
+        }
+        igraph_create(graph, &edges, 0, IGRAPH_UNDIRECTED);
+        igraph_vector_destroy(&edges);
+        return 0;
+    }
+    free(line);
+    return EOF;
+}
+
+void graham_config_init(graham_config_t *config) {
+    config->maxn = 8;
+    config->maxdegree = 4;
+    config->engine = GRAHAM_ENGINE_PAIRWISE;
+    config->threads = 0;
+    config->incremental = 1;
+    config->counters = 0;
+    config->schedule = GRAHAM_SCHEDULE_DYNAMIC;
+    config->chunk = 0;
+    config->batch = 64;
+    config->bliss_sh = IGRAPH_BLISS_F;
+}
+
+int graham_config_check(const graham_config_t *config) {
+    if (config->maxn < 2 || config->maxn > GRAHAM_MAXN) {
+        IGRAPH_ERROR("maxn must be between 2 and GRAHAM_MAXN", IGRAPH_EINVAL);
+    }
+    if (config->maxdegree < 1) {
+        IGRAPH_ERROR("maxdegree must be positive", IGRAPH_EINVAL);
+    }
+    if (config->engine != GRAHAM_ENGINE_PAIRWISE && config->engine != GRAHAM_ENGINE_CANONICAL) {
+        IGRAPH_ERROR("Unknown engine", IGRAPH_EINVAL);
+    }
+    if (config->threads < 0) {
+        IGRAPH_ERROR("threads must not be negative", IGRAPH_EINVAL);
+    }
+    if (config->schedule < GRAHAM_SCHEDULE_STATIC || config->schedule > GRAHAM_SCHEDULE_GUIDED) {
+        IGRAPH_ERROR("Unknown schedule", IGRAPH_EINVAL);
+    }
+    if (config->chunk < 0 || config->batch < 1) {
+        IGRAPH_ERROR("chunk must not be negative and batch must be positive", IGRAPH_EINVAL);
+    }
+    return 0;
+}
+
+/* Frees enumerator clusters, some of which may not have built their graph */
+static void free_clusters(igraph_vector_ptr_t *clusters) {
+    for (long i = 0; i < igraph_vector_ptr_size(clusters); i++) {
+        cluster_t *cluster = VECTOR(*clusters)[i];
+        if (cluster->has_graph) {
+            igraph_destroy(&cluster->graph);
+        }
+        free(cluster->seed);
+        free(cluster);
+    }
+    igraph_vector_ptr_clear(clusters);
+}
+
+static void build_graph(cluster_t *cluster, int n) {
+    igraph_vector_t edges;
+
+    igraph_vector_init(&edges, 0);
+    for (int v = 1; v < n; v++) {
+        for (uint64_t m = cluster->rows[v] & ((1ULL << v) - 1); m; m &= m - 1) {
+            igraph_vector_push_back(&edges, (igraph_real_t) __builtin_ctzll(m));
+            igraph_vector_push_back(&edges, (igraph_real_t) v);
+        }
+    }
+    igraph_create(&cluster->graph, &edges, n, IGRAPH_UNDIRECTED);
+    igraph_vector_destroy(&edges);
+    cluster->has_graph = true;
+}
+
+typedef struct {
+    graham_enumerator_t *e;
+    long parent;
+} expand_arg_t;
+
+/* kernel_emit_t: copies a child out of the kernel's scratch rows */
+static void emit_child(const uint64_t *rows, int n, uint64_t mask, void *arg) {
+    expand_arg_t *expand = arg;
+    cluster_t *candidate = malloc(sizeof(cluster_t) + n * sizeof(uint64_t));
+
+    candidate->has_graph = false;
+    candidate->seed = NULL;
+    candidate->parent = expand->parent;
+    candidate->mask = mask;
+    memcpy(candidate->rows, rows, n * sizeof(uint64_t));
+    if (expand->e->config.engine == GRAHAM_ENGINE_PAIRWISE) {
+        build_graph(candidate, n);
+    }
+    igraph_vector_ptr_push_back(&expand->e->candidates, candidate);
+}
+
+/* Hands a confirmed unique cluster to the caller and records it as a seed */
+static void accept(graham_enumerator_t *e, cluster_t *cluster) {
+    graham_cluster_t view;
+
+    if (!cluster->has_graph) {
+        build_graph(cluster, e->n);
+    }
+    igraph_vector_ptr_push_back(&e->unique, cluster);
+    if (e->on_cluster == NULL || e->stopped) {
+        return;
+    }
+    view.n = e->n;
+    view.id = igraph_vector_ptr_size(&e->unique) - 1;
+    view.parent = cluster->parent;
+    view.mask = cluster->mask;
+    view.graph = &cluster->graph;
+
+    perf_sample_t before, after;
+    int thread = omp_get_thread_num();
+    if (e->config.counters) {
+        perf_read(&e->perf, thread, &before);
+    }
+    double start = omp_get_wtime();
+    e->stopped = e->on_cluster(&view, e->arg);
+    e->callback_time += omp_get_wtime() - start;
+    if (e->config.counters) {
+        perf_read(&e->perf, thread, &after);
+        perf_diff(&after, &after, &before);
+        perf_add(&e->perf_threads[GRAHAM_PHASE_WRITE * e->perf.nthreads + thread], &after);
+    }
+}
+
+static void phase_begin(graham_enumerator_t *e) {
+    for (int t = 0; e->config.counters && t < e->perf.nthreads; t++) {
+        perf_read(&e->perf, t, &e->perf_begin[t]);
+    }
+}
+
+/* Charges every thread's counters since phase_begin to phase */
+static void phase_end(graham_enumerator_t *e, int phase) {
+    perf_sample_t now;
+    for (int t = 0; e->config.counters && t < e->perf.nthreads; t++) {
+        perf_read(&e->perf, t, &now);
+        perf_diff(&e->perf_threads[phase * e->perf.nthreads + t], &now, &e->perf_begin[t]);
+    }
+}
+
+/* Pairwise engine: candidate i is unique iff no earlier unique candidate
+ * matched it; it is confirmed as soon as the serial loop reaches it. */
+static void filter_unique(graham_enumerator_t *e) {
+    igraph_vector_ptr_t *graphs = &e->candidates;
+    long n_candidates = igraph_vector_ptr_size(graphs);
+    char *found = calloc(n_candidates, sizeof(char));
+
+    for (long i = 0; i < n_candidates; i++) {
+        if (found[i]) {
+            continue;
+        }
+        igraph_t *g1 = VECTOR(*graphs)[i];
+        igraph_bliss_sh_t sh = e->config.bliss_sh;
+        long matches = 0;
+        accept(e, VECTOR(*graphs)[i]);
+        #pragma omp parallel
+        {
+            double span = trace_now();
+            #pragma omp for schedule(runtime) nowait reduction(+:matches)
+            for (long j = i + 1; j < n_candidates; j++) {
+                igraph_bool_t iso = false;
+                if (!found[j]) {
+                    igraph_isomorphic_bliss(g1, VECTOR(*graphs)[j], &iso, NULL, NULL, sh, sh, NULL, NULL);
+                }
+                if (iso) {
+                    found[j] = true;
+                    matches++;
+                }
+            }
+            trace_span("compare", i, span);
+        }
+        e->stats.fates.class_sizes[graham_hist_bin(matches + 1)]++;
+    }
+    for (long i = 0; i < n_candidates; i++) {
+        if (found[i]) {
+            cluster_t *duplicate = VECTOR(*graphs)[i];
+            igraph_destroy(&duplicate->graph);
+            free(duplicate);
+        }
+    }
+    igraph_vector_ptr_clear(graphs);
+    free(found);
+}
+
+static inline uint64_t hash_words(const uint64_t *code, int words) {
+    uint64_t h = 0x9e3779b97f4a7c15ULL;
+    for (int w = 0; w < words; w++) {
+        h ^= code[w];
+        h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 31;
+    }
+    return h;
+}
+
+/* Canonical engine: codes are computed in parallel, config.batch candidates
+ * per work item, by the kernel straight from the adjacency rows, starting
+ * from the seed's metadata unless config.incremental is off, then inserted
+ * into an open-addressing set in candidate order so the first occurrence
+ * wins. Only the winners get an igraph_t, and they keep their own metadata
+ * if another level follows. */
+static void filter_canonical(graham_enumerator_t *e) {
+    igraph_vector_ptr_t *graphs = &e->candidates;
+    long n_candidates = igraph_vector_ptr_size(graphs);
+    int words = CODE_WORDS(e->n);
+    uint64_t *codes = calloc(n_candidates * words + 1, sizeof(uint64_t));
+    long slots = 1;
+    while (slots < 2 * n_candidates) {
+        slots <<= 1;
+    }
+    long *table = malloc(slots * sizeof(long));
+    long *class_size = calloc(n_candidates + 1, sizeof(long));
+    memset(table, 0xff, slots * sizeof(long));
+    int keep_seeds = e->n < e->config.maxn;
+    long refinements = 0, size = e->config.batch;
+    double start = omp_get_wtime();
+
+    #pragma omp parallel for schedule(runtime) reduction(+:refinements)
+    for (long batch = 0; batch < n_candidates; batch += size) {
+        double span = trace_now();
+        long end = batch + size < n_candidates ? batch + size : n_candidates;
+        for (long i = batch; i < end; i++) {
+            cluster_t *candidate = VECTOR(*graphs)[i];
+            const kernel_seed_t *parent = NULL;
+            if (e->config.incremental && e->n > 2) {
+                parent = ((cluster_t *) VECTOR(e->seeds)[candidate->parent])->seed;
+            }
+            if (keep_seeds) {
+                candidate->seed = malloc(KERNEL_SEED_SIZE(e->n, KERNEL_SEED_GENS));
+                candidate->seed->capacity = KERNEL_SEED_GENS;
+            }
+            refinements += e->kernel->canonical_seeded(candidate->rows, e->n, parent, candidate->mask,
+                                                       codes + i * words, NULL, NULL, candidate->seed);
+        }
+        trace_span("canonical", batch / size, span);
+    }
+    e->stats.refinements = refinements;
+    e->stats.canonical_ns = n_candidates ? (omp_get_wtime() - start) * 1e9 / n_candidates : 0;
+
+    double span = trace_now();
+    for (long i = 0; i < n_candidates; i++) {
+        const uint64_t *code = codes + i * words;
+        long slot = (long) (hash_words(code, words) & (slots - 1));
+        int duplicate = false;
+        while (table[slot] >= 0) {
+            if (memcmp(codes + table[slot] * words, code, words * sizeof(uint64_t)) == 0) {
+                duplicate = true;
+                break;
+            }
+            slot = (slot + 1) & (slots - 1);
+        }
+        cluster_t *candidate = VECTOR(*graphs)[i];
+        if (duplicate) {
+            class_size[table[slot]]++;
+            free(candidate->seed);
+            free(candidate);
+        } else {
+            if (candidate->seed != NULL) {
+                candidate->seed = realloc(candidate->seed, KERNEL_SEED_SIZE(e->n, candidate->seed->ngens));
+            }
+            table[slot] = i;
+            class_size[i] = 1;
+            accept(e, VECTOR(*graphs)[i]);
+        }
+    }
+    trace_span("insert", e->n, span);
+    for (long i = 0; i < n_candidates; i++) {
+        if (class_size[i] > 0) {
+            e->stats.fates.class_sizes[graham_hist_bin(class_size[i])]++;
+        }
+    }
+    igraph_vector_ptr_clear(graphs);
+    free(class_size);
+    free(table);
+    free(codes);
+}
+
+graham_enumerator_t *graham_enumerator_create(const graham_config_t *config) {
+    if (graham_config_check(config) != 0) {
+        return NULL;
+    }
+    graham_enumerator_t *e = calloc(1, sizeof(graham_enumerator_t));
+    e->config = *config;
+    e->kernel = kernel_select(config->maxn, config->maxdegree);
+    e->start = omp_get_wtime();
+    igraph_vector_ptr_init(&e->unique, 0);
+    igraph_vector_ptr_init(&e->seeds, 0);
+    igraph_vector_ptr_init(&e->candidates, 0);
+    return e;
+}
+
+void graham_enumerator_destroy(graham_enumerator_t *e) {
+    if (e == NULL) {
+        return;
+    }
+    if (e->perf.nthreads > 0) {
+        perf_close(&e->perf);
+        free(e->perf_begin);
+        free(e->perf_threads);
+    }
+    free_clusters(&e->unique);
+    free_clusters(&e->seeds);
+    free_clusters(&e->candidates);
+    igraph_vector_ptr_destroy(&e->unique);
+    igraph_vector_ptr_destroy(&e->seeds);
+    igraph_vector_ptr_destroy(&e->candidates);
+    free(e);
+}
+
+/* Computes the next level, handing each unique cluster to on_cluster.
+ * The first call produces the single-edge root (N = 2). Returns GRAHAM_DONE
+ * once maxn has been reached or a callback asked to stop. */
+int graham_enumerator_step(graham_enumerator_t *e, graham_cluster_callback_t *on_cluster, void *arg) {
+    graham_level_stats_t *stats = &e->stats;
+    double t, level_span, span;
+
+    if (e->stopped || e->n >= e->config.maxn) {
+        return GRAHAM_DONE;
+    }
+    level_span = trace_now();
+    if (e->config.threads > 0) {
+        omp_set_num_threads(e->config.threads);
+    }
+    static const omp_sched_t kinds[] = {omp_sched_static, omp_sched_dynamic, omp_sched_guided};
+    omp_set_schedule(kinds[e->config.schedule], e->config.chunk);
+    e->on_cluster = on_cluster;
+    e->arg = arg;
+    e->callback_time = 0;
+    memset(stats, 0, sizeof(*stats));
+    if (e->config.counters) {
+        if (e->perf.nthreads == 0) {
+            perf_init(&e->perf, omp_get_max_threads());
+            e->perf_begin = calloc(e->perf.nthreads, sizeof(perf_sample_t));
+            e->perf_threads = calloc(GRAHAM_NPHASES * e->perf.nthreads, sizeof(perf_sample_t));
+            #pragma omp parallel
+            perf_open_thread(&e->perf, omp_get_thread_num());
+        }
+        memset(e->perf_threads, 0, GRAHAM_NPHASES * e->perf.nthreads * sizeof(perf_sample_t));
+        stats->thread_counters = e->perf_threads;
+        stats->counter_threads = e->perf.nthreads;
+    }
+
+    phase_begin(e);
+    span = trace_now();
+    t = omp_get_wtime();
+    if (e->n == 0) {
+        cluster_t *root = calloc(1, sizeof(cluster_t) + 2 * sizeof(uint64_t));
+        root->rows[0] = 2;
+        root->rows[1] = 1;
+        build_graph(root, 2);
+        igraph_vector_ptr_push_back(&e->candidates, root);
+        stats->fates.subsets = 1;
+    } else {
+        expand_arg_t expand = {e, 0};
+        for (; expand.parent < igraph_vector_ptr_size(&e->unique); expand.parent++) {
+            cluster_t *seed = VECTOR(e->unique)[expand.parent];
+            double seed_span = trace_now();
+            long built = e->kernel->expand(seed->rows, e->n, e->config.maxdegree, emit_child, &expand);
+            trace_span("expand", expand.parent, seed_span);
+            stats->fates.subsets += built;
+            stats->fates.seed_children[graham_hist_bin(built)]++;
+        }
+        igraph_vector_ptr_t filled = e->unique;
+        e->unique = e->seeds;
+        e->seeds = filled;
+    }
+    e->n = e->n == 0 ? 2 : e->n + 1;
+    e->next = 0;
+    stats->n = e->n;
+    stats->candidates = igraph_vector_ptr_size(&e->candidates);
+    stats->generation_time = omp_get_wtime() - t;
+    phase_end(e, GRAHAM_PHASE_GENERATION);
+    trace_span("generation", e->n, span);
+
+    phase_begin(e);
+    span = trace_now();
+    t = omp_get_wtime();
+    if (e->config.engine == GRAHAM_ENGINE_CANONICAL) {
+        filter_canonical(e);
+    } else {
+        filter_unique(e);
+    }
+    free_clusters(&e->seeds);
+    stats->unique = igraph_vector_ptr_size(&e->unique);
+    stats->fates.children = stats->candidates;
+    stats->fates.duplicates = stats->candidates - stats->unique;
+    stats->fates.accepted = stats->unique;
+    phase_end(e, GRAHAM_PHASE_FILTER);
+    trace_span("filter", e->n, span);
+    for (int i = 0; e->config.counters && i < e->perf.nthreads; i++) {
+        perf_sample_t *filter = &e->perf_threads[GRAHAM_PHASE_FILTER * e->perf.nthreads + i];
+        perf_sub(filter, &e->perf_threads[GRAHAM_PHASE_WRITE * e->perf.nthreads + i]);
+        for (int phase = 0; phase < GRAHAM_NPHASES; phase++) {
+            perf_add(&stats->counters[phase], &e->perf_threads[phase * e->perf.nthreads + i]);
+        }
+    }
+    stats->callback_time = e->callback_time;
+    stats->filter_time = omp_get_wtime() - t - e->callback_time;
+    e->total += stats->unique;
+    stats->total = e->total;
+    stats->total_time = omp_get_wtime() - e->start;
+    trace_span("level", e->n, level_span);
+    return 0;
+}
+
+/* Approximate heap bytes held by one enumerator cluster with n vertices and
+ * edges edges: the struct and its rows, the igraph_t once built (edge and
+ * index vectors of igraph_real_t) and canonical-engine seed metadata. */
+double graham_cluster_bytes(const graham_config_t *config, int n, double edges, int has_graph) {
+    double bytes = sizeof(cluster_t) + n * sizeof(uint64_t) + sizeof(void *);
+    if (has_graph) {
+        bytes += (4 * edges + 2 * (n + 1)) * sizeof(igraph_real_t);
+    }
+    if (config->engine == GRAHAM_ENGINE_CANONICAL && n < config->maxn) {
+        bytes += KERNEL_SEED_SIZE(n, KERNEL_SEED_GENS);
+    }
+    return bytes;
+}
+
+/* Iterator interface: fills cluster with the next unique cluster, computing
+ * levels on demand. Returns 1 while clusters remain and 0 when exhausted. */
+int graham_enumerator_next(graham_enumerator_t *e, graham_cluster_t *cluster) {
+    while (e->next >= igraph_vector_ptr_size(&e->unique)) {
+        if (graham_enumerator_step(e, NULL, NULL) != 0) {
+            return 0;
+        }
+    }
+    cluster_t *c = VECTOR(e->unique)[e->next];
+    cluster->n = e->n;
+    cluster->id = e->next++;
+    cluster->parent = c->parent;
+    cluster->mask = c->mask;
+    cluster->graph = &c->graph;
+    return 1;
+}
+
+const graham_level_stats_t *graham_enumerator_stats(const graham_enumerator_t *e) {
+    return &e->stats;
+}
+
+/* Name of the kernel instantiation picked for this configuration */
+const char *graham_enumerator_kernel(const graham_enumerator_t *e) {
+    return e->kernel->name;
+}
+
+/* Runs a complete enumeration up to config->maxn. on_level is called after
+ * every level, including the root; either callback may be NULL. */
+int graham_enumerate(const graham_config_t *config,
+                     graham_cluster_callback_t *on_cluster,
+                     graham_level_callback_t *on_level, void *arg) {
+    graham_enumerator_t *e = graham_enumerator_create(config);
+
+    if (e == NULL) {
+        return IGRAPH_EINVAL;
+    }
+    while (graham_enumerator_step(e, on_cluster, arg) == 0) {
+        if (on_level != NULL) {
+            on_level(&e->stats, arg);
+        }
+    }
+    graham_enumerator_destroy(e);
+    return 0;
+}
+
+int graham_hist_bin(long value) {
+    int bin = value > 0 ? 64 - __builtin_clzll((unsigned long long) value) : 0;
+    return bin < GRAHAM_HIST_BINS ? bin : GRAHAM_HIST_BINS - 1;
+}
+
+void graham_fates_add(graham_fates_t *total, const graham_fates_t *fates) {
+    total->subsets += fates->subsets;
+    total->orbit_pruned += fates->orbit_pruned;
+    total->children += fates->children;
+    total->canonical_rejected += fates->canonical_rejected;
+    total->duplicates += fates->duplicates;
+    total->accepted += fates->accepted;
+    for (int b = 0; b < GRAHAM_HIST_BINS; b++) {
+        total->class_sizes[b] += fates->class_sizes[b];
+        total->seed_children[b] += fates->seed_children[b];
+    }
+}
+
+static void write_hist(FILE *out, const char *name, const long *hist) {
+    int bins = GRAHAM_HIST_BINS;
+    while (bins > 0 && hist[bins - 1] == 0) {
+        bins--;
+    }
+    fprintf(out, ", \"%s\": [", name);
+    for (int b = 0; b < bins; b++) {
+        fprintf(out, "%s%li", b ? ", " : "", hist[b]);
+    }
+    fprintf(out, "]");
+}
+
+/* Writes one level's fates as a single JSON line (JSON Lines). Histograms
+ * are trimmed after their last non-empty bin. */
+int graham_write_fates(FILE *out, int n, const graham_fates_t *fates) {
+    fprintf(out, "{\"n\": %i, \"subsets\": %li, \"orbit_pruned\": %li, \"children\": %li, "
+                 "\"canonical_rejected\": %li, \"duplicates\": %li, \"accepted\": %li",
+            n, fates->subsets, fates->orbit_pruned, fates->children,
+            fates->canonical_rejected, fates->duplicates, fates->accepted);
+    write_hist(out, "class_sizes", fates->class_sizes);
+    write_hist(out, "seed_children", fates->seed_children);
+    if (fprintf(out, "}\n") < 0) {
+        IGRAPH_ERROR("Write error", IGRAPH_EFILE);
+    }
+    return 0;
+}
+
+int graham_writer_open(graham_writer_t *writer, graham_format_t format, const char *path) {
+    memset(writer, 0, sizeof(*writer));
+    writer->format = format;
+    if (format == GRAHAM_FORMAT_TEXT) {
+        writer->text = fopen(path, "w");
+        if (writer->text == NULL) {
+            IGRAPH_ERROR("Cannot open output file", IGRAPH_EFILE);
+        }
+    } else if (format == GRAHAM_FORMAT_TREE) {
+        IGRAPH_CHECK(treecat_writer_open(&writer->tree, path));
+    }
+    return 0;
+}
+
+/* Cluster callback that streams every cluster to the writer passed as arg */
+int graham_write_cluster(const graham_cluster_t *cluster, void *arg) {
+    graham_writer_t *writer = arg;
+
+    if (writer->format == GRAHAM_FORMAT_TEXT) {
+        return write_graph(cluster->graph, writer->text);
+    }
+    if (writer->format == GRAHAM_FORMAT_TREE) {
+        if (cluster->n != writer->level) {
+            if (writer->level != 0) {
+                IGRAPH_CHECK(treecat_end_level(&writer->tree));
+            }
+            IGRAPH_CHECK(treecat_begin_level(&writer->tree, cluster->n));
+            writer->level = cluster->n;
+        }
+        return treecat_append(&writer->tree, cluster->parent, cluster->mask);
+    }
+    return 0;
+}
+
+int graham_writer_close(graham_writer_t *writer) {
+    if (writer->format == GRAHAM_FORMAT_TEXT) {
+        if (fclose(writer->text) != 0) {
+            IGRAPH_ERROR("Write error", IGRAPH_EFILE);
+        }
+    } else if (writer->format == GRAHAM_FORMAT_TREE) {
+        if (writer->level != 0) {
+            IGRAPH_CHECK(treecat_end_level(&writer->tree));
+        }
+        IGRAPH_CHECK(treecat_writer_close(&writer->tree));
+    }
+    writer->format = GRAHAM_FORMAT_NONE;
+    return 0;
+}
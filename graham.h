@@ -0,0 +1,217 @@
+//
+// graham: enumeration of connected, degree-bounded graphs (clusters) up to
+// isomorphism, grown one vertex at a time from a single edge.
+//
+
+#ifndef GRAHAM_H
+#define GRAHAM_H
+
+#include <igraph/igraph.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "treecat.h"
+#include "perfctr.h"
+
+#define GRAHAM_MAXN 64
+#define GRAHAM_DONE 1
+
+// phases of a level for the hardware counters
+#define GRAHAM_PHASE_GENERATION 0
+#define GRAHAM_PHASE_FILTER 1
+#define GRAHAM_PHASE_WRITE 2       // inside the cluster callback
+#define GRAHAM_NPHASES 3
+
+// histogram bins: bin 0 counts zeros, bin b counts values in [2^(b-1), 2^b)
+#define GRAHAM_HIST_BINS 24
+
+typedef enum {
+    GRAHAM_ENGINE_PAIRWISE,     // bliss isomorphism test against every other candidate
+    GRAHAM_ENGINE_CANONICAL     // kernel canonical codes in a hash set
+} graham_engine_t;
+
+typedef enum {
+    GRAHAM_SCHEDULE_STATIC,
+    GRAHAM_SCHEDULE_DYNAMIC,
+    GRAHAM_SCHEDULE_GUIDED
+} graham_schedule_t;
+
+typedef struct {
+    int maxn;                   // largest cluster size to enumerate
+    int maxdegree;              // degree cap for every vertex
+    graham_engine_t engine;
+    int threads;                // OpenMP threads, 0 for the runtime default
+    int incremental;            // canonical engine: start children from their seed's refinement
+    int counters;               // collect hardware counters per phase and thread (perfctr.h)
+    graham_schedule_t schedule; // OpenMP schedule of the filter loops
+    int chunk;                  // schedule chunk size, 0 for the OpenMP default
+    int batch;                  // canonical engine: candidates per parallel work item
+    igraph_bliss_sh_t bliss_sh; // pairwise engine: bliss splitting heuristic
+} graham_config_t;
+
+/* A unique cluster as delivered to callers. graph stays valid until the
+ * enumerator has computed the next level (the cluster is a seed for it). */
+typedef struct {
+    int n;                      // number of vertices
+    long id;                    // index within its level, in delivery order
+    long parent;                // id of the seed it was grown from (level n - 1)
+    uint64_t mask;              // bit v set when vertex n - 1 is attached to parent vertex v
+    const igraph_t *graph;
+} graham_cluster_t;
+
+/* Where the candidates of one level went, stage by stage. Stages a mode
+ * does not have stay 0 (orbit pruning and the canonical test are count-only,
+ * duplicates are the enumerator's). */
+typedef struct {
+    long subsets;               // attachment subsets enumerated from the seeds
+    long orbit_pruned;          // subsets skipped as images of another under the seed's automorphisms
+    long children;              // children built
+    long canonical_rejected;    // children failing the canonical augmentation test
+    long duplicates;            // children isomorphic to an earlier child
+    long accepted;              // unique clusters
+    long class_sizes[GRAHAM_HIST_BINS];     // children per accepted cluster (dedup bucket sizes)
+    long seed_children[GRAHAM_HIST_BINS];   // children built per seed
+} graham_fates_t;
+
+typedef struct {
+    int n;
+    long candidates;
+    long unique;
+    long total;                 // unique clusters found so far, all levels
+    double generation_time;
+    double filter_time;
+    double callback_time;       // time spent in the caller's cluster callback
+    double total_time;          // wall time since the enumerator was created
+    long refinements;           // canonical engine: refinement passes over all candidates
+    double canonical_ns;        // canonical engine: wall nanoseconds per candidate
+    perf_sample_t counters[GRAHAM_NPHASES];     // config.counters: summed over threads
+    const perf_sample_t *thread_counters;       // [phase * counter_threads + thread]
+    int counter_threads;                        // 0 when counters are off
+    graham_fates_t fates;
+} graham_level_stats_t;
+
+/* Called for every unique cluster as soon as it is confirmed, on the calling
+ * thread and in id order. Returning nonzero stops the enumeration. */
+typedef int graham_cluster_callback_t(const graham_cluster_t *cluster, void *arg);
+typedef void graham_level_callback_t(const graham_level_stats_t *stats, void *arg);
+
+typedef struct graham_enumerator graham_enumerator_t;
+
+/* Result of graham_count: how many clusters of each size, broken down by
+ * edge count and by largest vertex degree */
+typedef struct {
+    int maxn;
+    int maxedges;                                       // by_edges has maxedges + 1 columns
+    long by_n[GRAHAM_MAXN + 1];
+    long by_degree[GRAHAM_MAXN + 1][GRAHAM_MAXN + 1];   // [n][max degree]
+    long *by_edges;                                     // [n * (maxedges + 1) + edges]
+    graham_fates_t fates[GRAHAM_MAXN + 1];
+    double time;
+} graham_counts_t;
+
+typedef enum {
+    GRAHAM_FORMAT_NONE,
+    GRAHAM_FORMAT_TEXT,         // edge lists, one graph per line (nonisomorphic.txt)
+    GRAHAM_FORMAT_TREE          // (parent ID, attachment mask) records, see treecat.h
+} graham_format_t;
+
+/* Output sink; graham_write_cluster can be passed directly as the cluster callback */
+typedef struct {
+    graham_format_t format;
+    FILE *text;
+    treecat_writer_t tree;
+    int level;                  // level currently open in the tree writer
+} graham_writer_t;
+
+void graham_config_init(graham_config_t *config);
+int graham_config_check(const graham_config_t *config);
+
+graham_enumerator_t *graham_enumerator_create(const graham_config_t *config);
+void graham_enumerator_destroy(graham_enumerator_t *enumerator);
+int graham_enumerator_step(graham_enumerator_t *enumerator,
+                           graham_cluster_callback_t *on_cluster, void *arg);
+int graham_enumerator_next(graham_enumerator_t *enumerator, graham_cluster_t *cluster);
+const graham_level_stats_t *graham_enumerator_stats(const graham_enumerator_t *enumerator);
+const char *graham_enumerator_kernel(const graham_enumerator_t *enumerator);
+
+int graham_enumerate(const graham_config_t *config,
+                     graham_cluster_callback_t *on_cluster,
+                     graham_level_callback_t *on_level, void *arg);
+
+int graham_count(const graham_config_t *config, graham_counts_t *counts);
+void graham_counts_free(graham_counts_t *counts);
+
+/* Random-path estimates per N, with standard errors */
+typedef struct {
+    int maxn;
+    int exact;                              // levels up to here were counted, not sampled
+    long probes;
+    double unique[GRAHAM_MAXN + 1];
+    double unique_se[GRAHAM_MAXN + 1];
+    double candidates[GRAHAM_MAXN + 1];     // children the enumerator generates at N
+    double candidates_se[GRAHAM_MAXN + 1];
+    double edges[GRAHAM_MAXN + 1];          // mean edges per cluster
+    double time;
+} graham_estimate_t;
+
+int graham_estimate(const graham_config_t *config, long probes, uint64_t random_seed,
+                    graham_estimate_t *estimate);
+
+/* An estimate with bounds of two standard errors (about 95%) */
+typedef struct {
+    double estimate, low, high;
+} graham_range_t;
+
+typedef struct {
+    int n;
+    int measured;               // run during calibration: counts and time are exact
+    graham_range_t candidates, unique;
+    graham_range_t time;        // generation and filtering, seconds
+    graham_range_t memory;      // bytes held while the level is filtered
+} graham_plan_level_t;
+
+typedef struct {
+    int maxn;
+    int calibrated;             // levels up to here were run to measure costs
+    graham_estimate_t estimate;
+    graham_plan_level_t levels[GRAHAM_MAXN + 1];
+    graham_range_t time;        // all levels
+    graham_range_t memory;      // peak over the levels
+    double plan_time;           // seconds spent planning
+} graham_plan_t;
+
+typedef struct {
+    long probes;                // random paths taken
+    long samples;               // clusters delivered
+    long repeated;              // deliveries repeating the previous one (path weight above bound)
+    double bound;               // path weight delivered exactly once on average
+    double time;
+} graham_sample_stats_t;
+
+int graham_sample(const graham_config_t *config, long samples, uint64_t random_seed, double oversample,
+                  graham_cluster_callback_t *on_cluster, void *arg, graham_sample_stats_t *stats);
+
+int graham_plan(const graham_config_t *config, long probes, graham_plan_t *plan);
+double graham_cluster_bytes(const graham_config_t *config, int n, double edges, int has_graph);
+
+int graham_autotune(const graham_config_t *config, int tune_n, graham_config_t *tuned);
+int graham_tuning_save(const graham_config_t *config, const char *path);
+int graham_tuning_load(graham_config_t *config, const char *path);
+
+int graham_hist_bin(long value);
+void graham_fates_add(graham_fates_t *total, const graham_fates_t *fates);
+int graham_write_fates(FILE *out, int n, const graham_fates_t *fates);
+
+int graham_writer_open(graham_writer_t *writer, graham_format_t format, const char *path);
+int graham_write_cluster(const graham_cluster_t *cluster, void *writer);
+int graham_writer_close(graham_writer_t *writer);
+
+/* kernels shared by the drivers */
+void get_open_sites(const igraph_t *seed, int maxdegree, igraph_vector_t *open);
+void mutate_seed(const igraph_t *seed, long parent, int maxdegree, igraph_vector_ptr_t *candidates);
+igraph_bool_t isomorphic(const igraph_t *g1, const igraph_t *g2);
+void free_graphs_in_vector(igraph_vector_ptr_t *graphlist);
+void print_vertices(const igraph_t *graph);
+int write_graph(const igraph_t *graph, FILE *outstream);
+int read_graph(FILE *instream, igraph_t *graph);
+
+#endif //GRAHAM_H
@@ -0,0 +1,366 @@
+//
+// Kernel body, included by kernels.c once per instantiation with
+//   KW  word width in bits (16, 32 or 64), also the largest graph handled
+//   KD  degree cap, or 0 to take it from the maxdegree argument
+// Every instantiation produces identical results; only the word type and
+// the loop bounds the compiler can see differ.
+//
+
+#define KPASTE_(name, w, d) name##_##w##_##d
+#define KPASTE(name, w, d) KPASTE_(name, w, d)
+#define KFN(name) KPASTE(name, KW, KD)
+#define KWORD_(w) uint##w##_t
+#define KWORD(w) KWORD_(w)
+#define word_t KWORD(KW)
+
+#if KD > 0
+#define KDEG(maxdegree) KD
+#else
+#define KDEG(maxdegree) (maxdegree)
+#endif
+
+// room for up to KW automorphisms inherited from the parent plus those found
+#define KGENS (2 * KW)
+
+#if KW == 64
+#define KPOPCOUNT(x) __builtin_popcountll(x)
+#else
+#define KPOPCOUNT(x) __builtin_popcount(x)
+#endif
+
+typedef struct {
+    int n;
+    int words;
+    word_t adj[KW];
+    uint64_t best[KERNEL_MAX_WORDS];
+    uint64_t leaf[KERNEL_MAX_WORDS];
+    unsigned char best_lab[KW];
+    int have_best;
+    unsigned char path[KW];
+    unsigned char best_path[KW];
+    int jump;                       // depth the search backs up to after an automorphism
+    unsigned char gens[KGENS][KW];  // automorphisms known so far (vertex images)
+    int ngens;
+    long refinements;               // refinement passes
+} KFN(search_t);
+
+static uint64_t KFN(open_sites)(const uint64_t *rows, int n, int maxdegree) {
+    uint64_t open = 0;
+    for (int v = 0; v < n; v++) {
+        if (KPOPCOUNT((word_t) rows[v]) < KDEG(maxdegree)) {
+            open |= 1ULL << v;
+        }
+    }
+    return open;
+}
+
+/* Adds vertex n attached to mask, hands the child on, then removes it again */
+static inline void KFN(attach)(uint64_t *child, int n, uint64_t mask, kernel_emit_t *emit, void *arg) {
+    child[n] = mask;
+    for (uint64_t m = mask; m; m &= m - 1) {
+        child[__builtin_ctzll(m)] |= 1ULL << n;
+    }
+    emit(child, n + 1, mask, arg);
+    for (uint64_t m = mask; m; m &= m - 1) {
+        child[__builtin_ctzll(m)] &= ~(1ULL << n);
+    }
+}
+
+/* Emits every child of the seed: one per non-empty subset of at most
+ * maxdegree open sites, ordered by subset size and then colex order. */
+static long KFN(expand)(const uint64_t *rows, int n, int maxdegree, kernel_emit_t *emit, void *arg) {
+    uint64_t child[KW];
+    uint64_t open = KFN(open_sites)(rows, n, maxdegree);
+    int nopen = __builtin_popcountll(open);
+    int kmax = nopen < KDEG(maxdegree) ? nopen : KDEG(maxdegree);
+    long count = 0;
+
+    memcpy(child, rows, n * sizeof(uint64_t));
+    for (int k = 1; k <= kmax; k++) {
+        if (nopen <= SUBSET_TABLE_BITS && k <= SUBSET_TABLE_MAXK) {
+            const uint16_t *subset = subset_table[k];
+            long m = binomial[nopen][k];
+            for (long s = 0; s < m; s++) {
+                KFN(attach)(child, n, deposit(subset[s], open), emit, arg);
+            }
+            count += m;
+        } else {
+            uint64_t limit = nopen == 64 ? 0 : 1ULL << nopen;
+            for (uint64_t s = (1ULL << k) - 1; s != 0 && (limit == 0 || s < limit); s = next_subset(s)) {
+                KFN(attach)(child, n, deposit(s, open), emit, arg);
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+/* Refines color (k cells, numbered in an isomorphism-invariant order) to the
+ * coarsest equitable partition below it and returns the new number of cells. */
+static int KFN(refine)(const word_t *adj, int n, unsigned char *color, int k, long *passes) {
+    unsigned char sig[KW][KW + 1];
+    int order[KW];
+    word_t cell[KW];
+
+    for (;; ++*passes) {
+        memset(cell, 0, k * sizeof(word_t));
+        for (int v = 0; v < n; v++) {
+            cell[color[v]] |= (word_t) 1 << v;
+        }
+        for (int v = 0; v < n; v++) {
+            sig[v][0] = color[v];
+            for (int j = 0; j < k; j++) {
+                sig[v][j + 1] = (unsigned char) KPOPCOUNT(adj[v] & cell[j]);
+            }
+            order[v] = v;
+        }
+        for (int i = 1; i < n; i++) {
+            int v = order[i], j = i;
+            while (j > 0 && memcmp(sig[order[j - 1]], sig[v], k + 1) > 0) {
+                order[j] = order[j - 1];
+                j--;
+            }
+            order[j] = v;
+        }
+        int cells = 0;
+        for (int i = 0; i < n; i++) {
+            if (i > 0 && memcmp(sig[order[i - 1]], sig[order[i]], k + 1) != 0) {
+                cells++;
+            }
+            color[order[i]] = (unsigned char) cells;
+        }
+        if (++cells == k) {
+            return k;
+        }
+        k = cells;
+    }
+}
+
+static void KFN(leaf)(KFN(search_t) *s, const unsigned char *lab, int depth) {
+    memset(s->leaf, 0, s->words * sizeof(uint64_t));
+    for (int u = 0; u < s->n; u++) {
+        for (word_t m = s->adj[u]; m; m &= m - 1) {
+            int v = __builtin_ctzll(m);
+            if (v > u) {
+                int a = lab[u] < lab[v] ? lab[u] : lab[v];
+                int b = lab[u] < lab[v] ? lab[v] : lab[u];
+                long bit = (long) b * (b - 1) / 2 + a;
+                s->leaf[bit / 64] |= 1ULL << (bit % 64);
+            }
+        }
+    }
+    int cmp = s->have_best ? compare_code(s->leaf, s->best, s->words) : 1;
+    if (cmp > 0) {
+        memcpy(s->best, s->leaf, s->words * sizeof(uint64_t));
+        memcpy(s->best_lab, lab, s->n);
+        memcpy(s->best_path, s->path, depth);
+        s->have_best = 1;
+    } else if (cmp == 0) {
+        // same relabeled graph: lab followed by best_lab^-1 is an automorphism
+        unsigned char inverse[KW];
+        for (int w = 0; w < s->n; w++) {
+            inverse[s->best_lab[w]] = (unsigned char) w;
+        }
+        if (s->ngens < KGENS) {
+            for (int v = 0; v < s->n; v++) {
+                s->gens[s->ngens][v] = inverse[lab[v]];
+            }
+            s->ngens++;
+        }
+        // it maps the best leaf's subtree at the first differing choice onto
+        // this one, so the rest of this subtree has nothing new
+        s->jump = 0;
+        while (s->path[s->jump] == s->best_path[s->jump]) {
+            s->jump++;
+        }
+    }
+}
+
+/* Orbits of the automorphisms found so far that fix path[0..depth-1] */
+static void KFN(orbits)(const KFN(search_t) *s, int depth, unsigned char *orbit) {
+    for (int v = 0; v < s->n; v++) {
+        orbit[v] = (unsigned char) v;
+    }
+    for (int g = 0; g < s->ngens; g++) {
+        const unsigned char *gen = s->gens[g];
+        int fixes = 1;
+        for (int d = 0; d < depth && fixes; d++) {
+            fixes = gen[s->path[d]] == s->path[d];
+        }
+        for (int v = 0; fixes && v < s->n; v++) {
+            int a = orbit_find(orbit, v), b = orbit_find(orbit, gen[v]);
+            if (a != b) {
+                orbit[a > b ? a : b] = (unsigned char) (a < b ? a : b);
+            }
+        }
+    }
+}
+
+static void KFN(search)(KFN(search_t) *s, unsigned char *color, int k, int depth) {
+    unsigned char child[KW], orbit[KW], map[2 * KW];
+    int sizes[KW] = {0};
+    int target = -1, seen_gens = -1;
+    uint64_t explored = 0;
+
+    k = KFN(refine)(s->adj, s->n, color, k, &s->refinements);
+    if (k == s->n) {
+        KFN(leaf)(s, color, depth);
+        return;
+    }
+    for (int v = 0; v < s->n; v++) {
+        sizes[color[v]]++;
+    }
+    for (int j = 0; j < k && target < 0; j++) {
+        if (sizes[j] > 1) {
+            target = j;
+        }
+    }
+
+    for (int v = 0; v < s->n; v++) {
+        if (color[v] != target) {
+            continue;
+        }
+        if (s->ngens != seen_gens) {
+            KFN(orbits)(s, depth, orbit);
+            seen_gens = s->ngens;
+        }
+        int pruned = 0;
+        for (uint64_t m = explored; m && !pruned; m &= m - 1) {
+            pruned = orbit_find(orbit, __builtin_ctzll(m)) == orbit_find(orbit, v);
+        }
+        if (pruned) {
+            continue;
+        }
+
+        // individualize v: it moves ahead of the rest of its cell
+        memset(map, 0, 2 * k);
+        for (int u = 0; u < s->n; u++) {
+            child[u] = (unsigned char) (2 * color[u] + (u != v));
+            map[child[u]] = 1;
+        }
+        for (int c = 0, next = 0; c < 2 * k; c++) {
+            map[c] = map[c] ? (unsigned char) next++ : 0;
+        }
+        for (int u = 0; u < s->n; u++) {
+            child[u] = map[child[u]];
+        }
+        s->path[depth] = (unsigned char) v;
+        KFN(search)(s, child, k + 1, depth + 1);
+        explored |= 1ULL << v;
+        if (s->jump < depth) {
+            return;
+        }
+        s->jump = KW;
+    }
+}
+
+/* Canonical code and labeling (labeling[v] = canonical id of v) and the
+ * automorphism orbits (orbit[v] = smallest vertex in the orbit of v); each
+ * output may be NULL. The generators found are complete, so the orbits are
+ * exact. With a parent, rows must be one of its children (new vertex n - 1 attached
+ * to mask): the degree partition is derived from the parent's degrees instead
+ * of refining the unit partition, and the parent's automorphisms that fix mask
+ * seed the orbit pruning. Neither changes the code, only the work done.
+ * seed, when given, receives this graph's own metadata for its children.
+ * Returns the number of refinement passes. */
+static long KFN(canonical_seeded)(const uint64_t *rows, int n, const kernel_seed_t *parent, uint64_t mask,
+                                  uint64_t *code, int *labeling, int *orbit, kernel_seed_t *seed) {
+    KFN(search_t) s;
+    unsigned char color[KW], degree[KW], orbits[KW];
+    int k = 1;
+
+    s.n = n;
+    s.words = CODE_WORDS(n);
+    s.have_best = 0;
+    s.ngens = 0;
+    s.jump = KW;
+    s.refinements = 0;
+    for (int v = 0; v < n; v++) {
+        s.adj[v] = (word_t) rows[v];
+        color[v] = 0;
+    }
+    if (parent != NULL && n > 1) {
+        for (int v = 0; v < n - 1; v++) {
+            degree[v] = (unsigned char) (parent->data[v] + (mask >> v & 1));
+        }
+        degree[n - 1] = (unsigned char) __builtin_popcountll(mask);
+
+        // the same cells, in the same order, as the first pass from the unit partition
+        int used[KW + 1] = {0};
+        for (int v = 0; v < n; v++) {
+            used[degree[v]] = 1;
+        }
+        for (int d = 0, next = 0; d <= n; d++) {
+            used[d] = used[d] ? next++ : 0;
+            k = next;
+        }
+        for (int v = 0; v < n; v++) {
+            color[v] = (unsigned char) used[degree[v]];
+        }
+
+        for (int g = 0; g < parent->ngens && s.ngens < KW; g++) {
+            const unsigned char *gen = KERNEL_SEED_GEN(parent, g);
+            uint64_t image = 0;
+            for (uint64_t m = mask; m; m &= m - 1) {
+                image |= 1ULL << gen[__builtin_ctzll(m)];
+            }
+            if (image == mask) {
+                memcpy(s.gens[s.ngens], gen, n - 1);
+                s.gens[s.ngens++][n - 1] = (unsigned char) (n - 1);
+            }
+        }
+    } else {
+        for (int v = 0; v < n; v++) {
+            degree[v] = (unsigned char) KPOPCOUNT((word_t) rows[v]);
+        }
+    }
+    if (n > 0) {
+        KFN(search)(&s, color, k, 0);
+    }
+    memcpy(code, s.best, s.words * sizeof(uint64_t));
+    for (int v = 0; labeling != NULL && v < n; v++) {
+        labeling[v] = s.best_lab[v];
+    }
+    if (orbit != NULL) {
+        KFN(orbits)(&s, 0, orbits);
+        for (int v = 0; v < n; v++) {
+            orbit[v] = orbit_find(orbits, v);
+        }
+    }
+    if (seed != NULL) {
+        seed->n = (unsigned char) n;
+        seed->ngens = (unsigned char) (s.ngens < seed->capacity ? s.ngens : seed->capacity);
+        memcpy(seed->data, degree, n);
+        for (int g = 0; g < seed->ngens; g++) {
+            memcpy(KERNEL_SEED_GEN(seed, g), s.gens[g], n);
+        }
+    }
+    return s.refinements;
+}
+
+static void KFN(canonical)(const uint64_t *rows, int n, uint64_t *code, int *labeling) {
+    KFN(canonical_seeded)(rows, n, NULL, 0, code, labeling, NULL, NULL);
+}
+
+static const kernel_t KFN(kernel) = {
+    KERNEL_NAME,
+    KW,
+    KD,
+    KFN(open_sites),
+    KFN(expand),
+    KFN(canonical),
+    KFN(canonical_seeded)
+};
+
+#undef KPASTE_
+#undef KPASTE
+#undef KFN
+#undef KWORD_
+#undef KWORD
+#undef word_t
+#undef KDEG
+#undef KPOPCOUNT
+#undef KGENS
+#undef KERNEL_NAME
+#undef KW
+#undef KD
@@ -0,0 +1,170 @@
+//
+// Kernel instantiations and the runtime dispatcher.
+//
+
+#include "kernels.h"
+#include <string.h>
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+// k-subsets of up to SUBSET_TABLE_BITS open sites come from a table in colex
+// order, so the subsets of the first n sites are a prefix of each row
+#define SUBSET_TABLE_BITS 16
+#define SUBSET_TABLE_MAXK 6
+#define SUBSET_TABLE_SIZE (16 + 120 + 560 + 1820 + 4368 + 8008)
+
+static uint16_t subset_storage[SUBSET_TABLE_SIZE];
+static const uint16_t *subset_table[SUBSET_TABLE_MAXK + 1];
+static long binomial[KERNEL_MAXN + 1][KERNEL_MAXN + 1];
+static volatile int tables_built = 0;
+
+/* Next larger integer with the same number of set bits (Gosper's hack), 0 on overflow */
+static inline uint64_t next_subset(uint64_t s) {
+    uint64_t c = s & -s;
+    uint64_t r = s + c;
+    if (r == 0) {
+        return 0;
+    }
+    return (((r ^ s) >> 2) / c) | r;
+}
+
+/* Scatters the low bits of bits onto the set bits of mask, lowest first */
+static inline uint64_t deposit(uint64_t bits, uint64_t mask) {
+#ifdef __BMI2__
+    return _pdep_u64(bits, mask);
+#else
+    uint64_t out = 0;
+    for (; bits && mask; bits >>= 1, mask &= mask - 1) {
+        if (bits & 1) {
+            out |= mask & -mask;
+        }
+    }
+    return out;
+#endif
+}
+
+static inline int compare_code(const uint64_t *a, const uint64_t *b, int words) {
+    for (int w = 0; w < words; w++) {
+        if (a[w] != b[w]) {
+            return a[w] > b[w] ? 1 : -1;
+        }
+    }
+    return 0;
+}
+
+static inline int orbit_find(unsigned char *orbit, int v) {
+    while (orbit[v] != v) {
+        v = orbit[v] = orbit[orbit[v]];
+    }
+    return v;
+}
+
+static void build_tables(void) {
+    if (tables_built) {
+        return;
+    }
+    #pragma omp critical (kernel_tables)
+    {
+        if (!tables_built) {
+            long next = 0;
+            for (int n = 0; n <= KERNEL_MAXN; n++) {
+                binomial[n][0] = 1;
+                for (int k = 1; k <= n; k++) {
+                    binomial[n][k] = binomial[n - 1][k - 1] + (k < n ? binomial[n - 1][k] : 0);
+                }
+            }
+            for (int k = 1; k <= SUBSET_TABLE_MAXK; k++) {
+                subset_table[k] = subset_storage + next;
+                for (uint64_t s = (1ULL << k) - 1; s < (1ULL << SUBSET_TABLE_BITS); s = next_subset(s)) {
+                    subset_storage[next++] = (uint16_t) s;
+                }
+            }
+            tables_built = 1;
+        }
+    }
+}
+
+#define KW 16
+#define KD 0
+#define KERNEL_NAME "n16"
+#include "kernel_impl.h"
+#define KW 16
+#define KD 3
+#define KERNEL_NAME "n16_d3"
+#include "kernel_impl.h"
+#define KW 16
+#define KD 4
+#define KERNEL_NAME "n16_d4"
+#include "kernel_impl.h"
+#define KW 16
+#define KD 5
+#define KERNEL_NAME "n16_d5"
+#include "kernel_impl.h"
+#define KW 16
+#define KD 6
+#define KERNEL_NAME "n16_d6"
+#include "kernel_impl.h"
+
+#define KW 32
+#define KD 0
+#define KERNEL_NAME "n32"
+#include "kernel_impl.h"
+#define KW 32
+#define KD 3
+#define KERNEL_NAME "n32_d3"
+#include "kernel_impl.h"
+#define KW 32
+#define KD 4
+#define KERNEL_NAME "n32_d4"
+#include "kernel_impl.h"
+#define KW 32
+#define KD 5
+#define KERNEL_NAME "n32_d5"
+#include "kernel_impl.h"
+#define KW 32
+#define KD 6
+#define KERNEL_NAME "n32_d6"
+#include "kernel_impl.h"
+
+#define KW 64
+#define KD 0
+#define KERNEL_NAME "n64"
+#include "kernel_impl.h"
+#define KW 64
+#define KD 3
+#define KERNEL_NAME "n64_d3"
+#include "kernel_impl.h"
+#define KW 64
+#define KD 4
+#define KERNEL_NAME "n64_d4"
+#include "kernel_impl.h"
+#define KW 64
+#define KD 5
+#define KERNEL_NAME "n64_d5"
+#include "kernel_impl.h"
+#define KW 64
+#define KD 6
+#define KERNEL_NAME "n64_d6"
+#include "kernel_impl.h"
+
+// rows: word width, columns: degree cap 0 (runtime), 3, 4, 5, 6
+static const kernel_t *const kernels[3][5] = {
+    {&kernel_16_0, &kernel_16_3, &kernel_16_4, &kernel_16_5, &kernel_16_6},
+    {&kernel_32_0, &kernel_32_3, &kernel_32_4, &kernel_32_5, &kernel_32_6},
+    {&kernel_64_0, &kernel_64_3, &kernel_64_4, &kernel_64_5, &kernel_64_6},
+};
+
+/* Narrowest kernel that holds maxn vertices, specialized for maxdegree when
+ * one was compiled; NULL when maxn exceeds KERNEL_MAXN. */
+const kernel_t *kernel_select(int maxn, int maxdegree) {
+    int width, degree;
+
+    if (maxn > KERNEL_MAXN) {
+        return NULL;
+    }
+    build_tables();
+    width = maxn <= 16 ? 0 : maxn <= 32 ? 1 : 2;
+    degree = (maxdegree >= 3 && maxdegree <= 6) ? maxdegree - 2 : 0;
+    return kernels[width][degree];
+}
@@ -0,0 +1,53 @@
+//
+// Bit-row kernels for the hot loops (open-site scan, subset enumeration,
+// child construction, canonicalization), compiled once per word width and
+// degree cap and picked at runtime by kernel_select.
+//
+
+#ifndef GRAHAM_KERNELS_H
+#define GRAHAM_KERNELS_H
+
+#include <stdint.h>
+
+#define KERNEL_MAXN 64
+// number of 64-bit words needed to hold the upper triangle of an n-vertex graph
+#define CODE_WORDS(n) ((((n) * ((n) - 1) / 2) + 63) / 64)
+#define KERNEL_MAX_WORDS CODE_WORDS(KERNEL_MAXN)
+
+/* Graphs are passed as adjacency bit rows: bit u of rows[v] is set iff u-v is
+ * an edge. Canonical codes set bit j * (j - 1) / 2 + i for every edge i < j of
+ * the canonically relabeled graph, so the code of an n-vertex graph is a
+ * prefix of the code of any n+1-vertex graph with the same first n labels. */
+
+/* What a unique seed keeps from its own canonicalization: its degree vector
+ * and up to capacity automorphisms. Variable length; allocate
+ * KERNEL_SEED_SIZE(n, capacity) bytes and set capacity to receive one.
+ * KERNEL_MAX_GENS is enough for every generator the search finds. */
+#define KERNEL_SEED_GENS 8
+#define KERNEL_MAX_GENS (2 * KERNEL_MAXN)
+typedef struct {
+    unsigned char n;
+    unsigned char capacity;
+    unsigned char ngens;
+    unsigned char data[];   // degree[n], then ngens vertex image arrays of length n
+} kernel_seed_t;
+#define KERNEL_SEED_SIZE(n, ngens) (sizeof(kernel_seed_t) + (size_t) (n) * (1 + (ngens)))
+#define KERNEL_SEED_GEN(seed, g) ((seed)->data + (size_t) (seed)->n * (1 + (g)))
+
+/* Receives one child: rows has n vertices, the last one attached to mask. */
+typedef void kernel_emit_t(const uint64_t *rows, int n, uint64_t mask, void *arg);
+
+typedef struct {
+    const char *name;
+    int maxn;           // widest graph this kernel handles
+    int maxdegree;      // degree cap it was compiled for, 0 when read at runtime
+    uint64_t (*open_sites)(const uint64_t *rows, int n, int maxdegree);
+    long (*expand)(const uint64_t *rows, int n, int maxdegree, kernel_emit_t *emit, void *arg);
+    void (*canonical)(const uint64_t *rows, int n, uint64_t *code, int *labeling);
+    long (*canonical_seeded)(const uint64_t *rows, int n, const kernel_seed_t *parent, uint64_t mask,
+                             uint64_t *code, int *labeling, int *orbit, kernel_seed_t *seed);
+} kernel_t;
+
+const kernel_t *kernel_select(int maxn, int maxdegree);
+
+#endif //GRAHAM_KERNELS_H
@@ -0,0 +1,124 @@
+//
+// perf_event_open counters, read from any thread at phase boundaries.
+//
+
+#define _GNU_SOURCE
+
+#include "perfctr.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+static const char *event_names[PERF_NEVENTS] = {
+    "cycles", "instructions", "llc_misses", "branch_misses", "ctx_switches"
+};
+
+void perf_init(perf_counters_t *counters, int nthreads) {
+    counters->nthreads = nthreads;
+    counters->fd = malloc(nthreads * sizeof(*counters->fd));
+    memset(counters->fd, 0xff, nthreads * sizeof(*counters->fd));
+}
+
+/* Opens the counters for the calling thread and stores them as thread;
+ * call it from each thread of the team. Events that fail stay closed. */
+void perf_open_thread(perf_counters_t *counters, int thread) {
+#ifdef __linux__
+    static const struct { uint32_t type; uint64_t config; } events[PERF_NEVENTS] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+    };
+    struct perf_event_attr attr;
+
+    if (thread >= counters->nthreads) {
+        return;
+    }
+    for (int e = 0; e < PERF_NEVENTS; e++) {
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = events[e].type;
+        attr.config = events[e].config;
+        // context switches happen in the kernel; the hardware events count user code only
+        attr.exclude_kernel = events[e].type == PERF_TYPE_HARDWARE;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        counters->fd[thread][e] = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+#endif
+}
+
+void perf_close(perf_counters_t *counters) {
+    for (int t = 0; t < counters->nthreads; t++) {
+        for (int e = 0; e < PERF_NEVENTS; e++) {
+            if (counters->fd[t][e] >= 0) {
+                close(counters->fd[t][e]);
+            }
+        }
+    }
+    free(counters->fd);
+    counters->fd = NULL;
+    counters->nthreads = 0;
+}
+
+/* Current totals of one thread, scaled up when the kernel multiplexed them */
+void perf_read(const perf_counters_t *counters, int thread, perf_sample_t *sample) {
+    uint64_t raw[3];
+
+    memset(sample, 0, sizeof(*sample));
+    if (thread >= counters->nthreads) {
+        return;
+    }
+    for (int e = 0; e < PERF_NEVENTS; e++) {
+        int fd = counters->fd[thread][e];
+        if (fd < 0 || read(fd, raw, sizeof(raw)) != sizeof(raw)) {
+            continue;
+        }
+        sample->value[e] = raw[2] > 0 && raw[2] < raw[1] ? (uint64_t) ((double) raw[0] * raw[1] / raw[2]) : raw[0];
+        sample->available |= 1u << e;
+    }
+}
+
+void perf_diff(perf_sample_t *out, const perf_sample_t *end, const perf_sample_t *begin) {
+    out->available = end->available & begin->available;
+    for (int e = 0; e < PERF_NEVENTS; e++) {
+        out->value[e] = end->value[e] - begin->value[e];
+    }
+}
+
+void perf_add(perf_sample_t *total, const perf_sample_t *sample) {
+    if (sample->available == 0) {
+        return;
+    }
+    total->available = total->available ? total->available & sample->available : sample->available;
+    for (int e = 0; e < PERF_NEVENTS; e++) {
+        total->value[e] += sample->value[e];
+    }
+}
+
+void perf_sub(perf_sample_t *total, const perf_sample_t *sample) {
+    for (int e = 0; e < PERF_NEVENTS; e++) {
+        total->value[e] = total->value[e] > sample->value[e] ? total->value[e] - sample->value[e] : 0;
+    }
+}
+
+/* One line per sample: each event per candidate, plus IPC; n/a when not counted */
+void perf_print(FILE *out, const char *label, const perf_sample_t *sample, long candidates) {
+    fprintf(out, "%10s", label);
+    for (int e = 0; e < PERF_NEVENTS; e++) {
+        if (sample->available & (1u << e)) {
+            fprintf(out, " %s/cand %.1f", event_names[e], candidates > 0 ? (double) sample->value[e] / candidates : 0.0);
+        } else {
+            fprintf(out, " %s n/a", event_names[e]);
+        }
+    }
+    if ((sample->available & 3u) == 3u && sample->value[PERF_CYCLES] > 0) {
+        fprintf(out, " ipc %.2f", (double) sample->value[PERF_INSTRUCTIONS] / sample->value[PERF_CYCLES]);
+    }
+    fprintf(out, "\n");
+}
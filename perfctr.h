@@ -0,0 +1,43 @@
+//
+// Hardware performance counters through perf_event_open, one set per
+// OpenMP thread. Every function is a no-op when the counters cannot be
+// opened (no permission, no PMU in a container, not Linux).
+//
+
+#ifndef GRAHAM_PERFCTR_H
+#define GRAHAM_PERFCTR_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+typedef enum {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_LLC_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_CONTEXT_SWITCHES,
+    PERF_NEVENTS
+} perf_event_t;
+
+typedef struct {
+    uint64_t value[PERF_NEVENTS];
+    unsigned available;             // bit e set when value[e] was counted
+} perf_sample_t;
+
+typedef struct {
+    int nthreads;
+    int (*fd)[PERF_NEVENTS];        // [thread][event], -1 when unavailable
+} perf_counters_t;
+
+void perf_init(perf_counters_t *counters, int nthreads);
+void perf_open_thread(perf_counters_t *counters, int thread);
+void perf_close(perf_counters_t *counters);
+
+void perf_read(const perf_counters_t *counters, int thread, perf_sample_t *sample);
+void perf_diff(perf_sample_t *out, const perf_sample_t *end, const perf_sample_t *begin);
+void perf_add(perf_sample_t *total, const perf_sample_t *sample);
+void perf_sub(perf_sample_t *total, const perf_sample_t *sample);
+
+void perf_print(FILE *out, const char *label, const perf_sample_t *sample, long candidates);
+
+#endif //GRAHAM_PERFCTR_H
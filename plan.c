@@ -0,0 +1,130 @@
+//
+// Run planner: random-path estimates of every level, per-candidate costs
+// measured on the small levels, and the time and memory they add up to.
+//
+
+#include "graham.h"
+#include "kernels.h"
+#include <math.h>
+#include <string.h>
+#include <omp.h>
+
+// calibration runs the levels whose summed work stays below these: candidates
+// for the canonical engine, candidates times unique for the pairwise one
+#define PLAN_CANONICAL_WORK 2e5
+#define PLAN_PAIRWISE_WORK 1e6
+
+#define PLAN_RANDOM_SEED 0x5eed
+
+static graham_range_t range(double estimate, double se) {
+    graham_range_t r = {estimate, fmax(estimate - 2 * se, 0), estimate + 2 * se};
+    return r;
+}
+
+static double work(const graham_config_t *config, double candidates, double unique) {
+    return config->engine == GRAHAM_ENGINE_CANONICAL ? candidates : candidates * unique;
+}
+
+/* Generation and filter seconds for a level, scaled from the calibration
+ * level c: canonical refinement touches O(n^2) adjacency bits per candidate,
+ * the pairwise engine runs one bliss test per candidate for every unique
+ * cluster found before it, each growing about linearly in n. */
+static double level_time(const graham_config_t *config, const graham_level_stats_t *c, int n,
+                         double candidates, double unique) {
+    double generation = c->generation_time / c->candidates;
+    double scale = (double) n / c->n;
+
+    if (config->engine == GRAHAM_ENGINE_CANONICAL) {
+        return candidates * (generation + c->filter_time / c->candidates * scale * scale);
+    }
+    return candidates * generation
+           + candidates * unique * c->filter_time / ((double) c->candidates * c->unique) * scale;
+}
+
+/* Bytes held while level n is filtered: the previous level as seeds, every
+ * candidate and, for the canonical engine, the codes, hash table and graphs
+ * of the accepted ones. */
+static double level_memory(const graham_config_t *config, int n, double seeds, double candidates,
+                           double unique, const double *edges) {
+    int pairwise = config->engine == GRAHAM_ENGINE_PAIRWISE;
+    double bytes = seeds * graham_cluster_bytes(config, n - 1, edges[n - 1], 1)
+                   + candidates * graham_cluster_bytes(config, n, edges[n], pairwise);
+
+    if (!pairwise) {
+        bytes += candidates * (CODE_WORDS(n) * sizeof(uint64_t) + 3 * sizeof(long))
+                 + unique * (graham_cluster_bytes(config, n, edges[n], 1) - graham_cluster_bytes(config, n, edges[n], 0));
+    }
+    return bytes;
+}
+
+static void save_level(const graham_level_stats_t *stats, void *arg) {
+    graham_level_stats_t *levels = arg;
+    levels[stats->n] = *stats;
+}
+
+/* Predicts what a run of config costs without doing it: graham_estimate
+ * with probes random paths sizes every level, the levels up to a small
+ * amount of work are run to measure time per candidate, and the rest are
+ * extrapolated. Bounds carry the estimates' two standard errors through;
+ * the cluster callback (writing) is not included. */
+int graham_plan(const graham_config_t *config, long probes, graham_plan_t *plan) {
+    graham_level_stats_t measured[GRAHAM_MAXN + 1];
+    graham_config_t calibration = *config;
+    const graham_estimate_t *est = &plan->estimate;
+    double start = omp_get_wtime();
+
+    memset(plan, 0, sizeof(*plan));
+    IGRAPH_CHECK(graham_estimate(config, probes, PLAN_RANDOM_SEED, &plan->estimate));
+    plan->maxn = config->maxn;
+
+    double limit = config->engine == GRAHAM_ENGINE_CANONICAL ? PLAN_CANONICAL_WORK : PLAN_PAIRWISE_WORK;
+    plan->calibrated = config->maxn < 4 ? config->maxn : 4;
+    for (double total = 0; plan->calibrated < config->maxn; plan->calibrated++) {
+        int n = plan->calibrated + 1;
+        total += work(config, est->candidates[n] + 2 * est->candidates_se[n], est->unique[n] + 2 * est->unique_se[n]);
+        if (total > limit) {
+            break;
+        }
+    }
+    calibration.maxn = plan->calibrated;
+    calibration.counters = 0;
+    memset(measured, 0, sizeof(measured));
+    IGRAPH_CHECK(graham_enumerate(&calibration, NULL, save_level, measured));
+
+    const graham_level_stats_t *c = &measured[plan->calibrated];
+    graham_range_t seeds = {0, 0, 0};
+    plan->time = range(0, 0);
+    plan->memory = range(0, 0);
+    for (int n = 2; n <= config->maxn; n++) {
+        graham_plan_level_t *level = &plan->levels[n];
+        level->n = n;
+        if (n <= plan->calibrated) {
+            double time = measured[n].generation_time + measured[n].filter_time;
+            level->measured = 1;
+            level->candidates = range(measured[n].candidates, 0);
+            level->unique = range(measured[n].unique, 0);
+            level->time = range(time, 0);
+        } else {
+            level->candidates = range(est->candidates[n], est->candidates_se[n]);
+            level->unique = range(est->unique[n], est->unique_se[n]);
+            level->time.estimate = level_time(config, c, n, level->candidates.estimate, level->unique.estimate);
+            level->time.low = level_time(config, c, n, level->candidates.low, level->unique.low);
+            level->time.high = level_time(config, c, n, level->candidates.high, level->unique.high);
+        }
+        level->memory.estimate = level_memory(config, n, seeds.estimate, level->candidates.estimate,
+                                              level->unique.estimate, est->edges);
+        level->memory.low = level_memory(config, n, seeds.low, level->candidates.low, level->unique.low, est->edges);
+        level->memory.high = level_memory(config, n, seeds.high, level->candidates.high, level->unique.high,
+                                          est->edges);
+        seeds = level->unique;
+
+        plan->time.estimate += level->time.estimate;
+        plan->time.low += level->time.low;
+        plan->time.high += level->time.high;
+        plan->memory.estimate = fmax(plan->memory.estimate, level->memory.estimate);
+        plan->memory.low = fmax(plan->memory.low, level->memory.low);
+        plan->memory.high = fmax(plan->memory.high, level->memory.high);
+    }
+    plan->plan_time = omp_get_wtime() - start;
+    return 0;
+}
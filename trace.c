@@ -0,0 +1,98 @@
+//
+// Span tracer storage and Chrome trace-event JSON writer.
+//
+
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    const char *name;
+    long arg;
+    double start;
+    double duration;
+} trace_event_t;
+
+typedef struct {
+    trace_event_t *events;
+    long next;                  // total spans recorded; the slot is next % TRACE_CAPACITY
+    char pad[64];
+} trace_thread_t;
+
+volatile int trace_enabled = 0;
+
+static trace_thread_t *threads;
+static int nthreads;
+static double origin;
+static char *output;
+
+/* Starts tracing every thread of the OpenMP team; spans are written to path
+ * by trace_close. */
+int trace_open(const char *path) {
+    if (trace_enabled) {
+        return 1;
+    }
+    nthreads = omp_get_max_threads();
+    threads = calloc(nthreads, sizeof(trace_thread_t));
+    for (int t = 0; t < nthreads; t++) {
+        threads[t].events = malloc(TRACE_CAPACITY * sizeof(trace_event_t));
+    }
+    output = malloc(strlen(path) + 1);
+    strcpy(output, path);
+    origin = omp_get_wtime();
+    trace_enabled = 1;
+    return 0;
+}
+
+void trace_record(const char *name, long arg, double start) {
+    int t = omp_get_thread_num();
+    if (t >= nthreads) {
+        return;
+    }
+    trace_thread_t *thread = &threads[t];
+    trace_event_t *event = &thread->events[thread->next++ % TRACE_CAPACITY];
+    event->name = name;
+    event->arg = arg;
+    event->start = start;
+    event->duration = omp_get_wtime() - start;
+}
+
+/* Writes the recorded spans and stops tracing. Returns nonzero if the file
+ * could not be written. */
+int trace_close(void) {
+    int first = 1, status = 0;
+
+    if (!trace_enabled) {
+        return 0;
+    }
+    trace_enabled = 0;
+    FILE *out = fopen(output, "w");
+    if (out == NULL) {
+        status = 1;
+    } else {
+        fprintf(out, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+        for (int t = 0; t < nthreads; t++) {
+            trace_thread_t *thread = &threads[t];
+            long begin = thread->next > TRACE_CAPACITY ? thread->next - TRACE_CAPACITY : 0;
+            for (long i = begin; i < thread->next; i++) {
+                const trace_event_t *event = &thread->events[i % TRACE_CAPACITY];
+                fprintf(out, "%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %i, "
+                             "\"ts\": %.3f, \"dur\": %.3f, \"args\": {\"id\": %li}}",
+                        first ? "" : ",\n", event->name, t,
+                        (event->start - origin) * 1e6, event->duration * 1e6, event->arg);
+                first = 0;
+            }
+        }
+        fprintf(out, "\n]}\n");
+        status = fclose(out) != 0;
+    }
+    for (int t = 0; t < nthreads; t++) {
+        free(threads[t].events);
+    }
+    free(threads);
+    free(output);
+    threads = NULL;
+    nthreads = 0;
+    return status;
+}
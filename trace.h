@@ -0,0 +1,33 @@
+//
+// Opt-in span tracer: per-thread ring buffers of (name, start, duration)
+// written as Chrome trace-event JSON (chrome://tracing, Perfetto) on close.
+// While no trace is open, trace_now and trace_span cost one load and branch.
+//
+
+#ifndef GRAHAM_TRACE_H
+#define GRAHAM_TRACE_H
+
+#include <omp.h>
+
+#define TRACE_CAPACITY (1 << 18)    // spans kept per thread; older ones are overwritten
+
+extern volatile int trace_enabled;
+
+int trace_open(const char *path);
+int trace_close(void);
+void trace_record(const char *name, long arg, double start);
+
+/* Start time for trace_span, 0 when tracing is off */
+static inline double trace_now(void) {
+    return trace_enabled ? omp_get_wtime() : 0;
+}
+
+/* Records a span from start until now on the calling thread. name must be a
+ * string literal (only the pointer is kept); arg shows up as args.id. */
+static inline void trace_span(const char *name, long arg, double start) {
+    if (trace_enabled) {
+        trace_record(name, arg, start);
+    }
+}
+
+#endif //GRAHAM_TRACE_H
@@ -0,0 +1,346 @@
+//
+// Tree-encoded catalog: writer, mmap reader and ancestor-caching reconstruction.
+//
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "treecat.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct treecat_entry {
+    int n;
+    long id;
+    uint64_t rows[TREECAT_MAXN];
+    treecat_entry_t *prev, *next;   // LRU list, most recent first
+    treecat_entry_t *chain;         // hash bucket chain
+};
+
+/* number of bytes needed to store values in [0, max_value] */
+static int bytes_for(uint64_t max_value) {
+    int bytes = 0;
+    while (max_value) {
+        bytes++;
+        max_value >>= 8;
+    }
+    return bytes;
+}
+
+static void put_bytes(unsigned char *p, uint64_t value, int bytes) {
+    for (int b = 0; b < bytes; b++) {
+        p[b] = (unsigned char) (value >> (8 * b));
+    }
+}
+
+static uint64_t get_bytes(const unsigned char *p, int bytes) {
+    uint64_t value = 0;
+    for (int b = 0; b < bytes; b++) {
+        value |= (uint64_t) p[b] << (8 * b);
+    }
+    return value;
+}
+
+int treecat_writer_open(treecat_writer_t *writer, const char *path) {
+    treecat_file_header_t header;
+
+    writer->out = fopen(path, "wb");
+    writer->prev_count = 0;
+    if (writer->out == NULL) {
+        IGRAPH_ERROR("Cannot open tree catalog", IGRAPH_EFILE);
+    }
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TREECAT_MAGIC, sizeof(header.magic));
+    header.version = TREECAT_VERSION;
+    header.root_n = TREECAT_ROOTN;
+    fwrite(&header, sizeof(header), 1, writer->out);
+    return 0;
+}
+
+/* Starts level n; records are then added with treecat_append. */
+int treecat_begin_level(treecat_writer_t *writer, int n) {
+    treecat_block_header_t *block = &writer->block;
+
+    if (n < TREECAT_ROOTN || n > TREECAT_MAXN) {
+        IGRAPH_ERROR("Level out of range for tree catalog", IGRAPH_EINVAL);
+    }
+    memset(block, 0, sizeof(*block));
+    block->n = n;
+    if (n > TREECAT_ROOTN) {
+        block->parent_bytes = bytes_for(writer->prev_count > 1 ? writer->prev_count - 1 : 0);
+        block->mask_bytes = (n - 1 + 7) / 8;
+    }
+    writer->block_offset = ftell(writer->out);
+    if (fwrite(block, sizeof(*block), 1, writer->out) != 1) {
+        IGRAPH_ERROR("Write error", IGRAPH_EFILE);
+    }
+    return 0;
+}
+
+/* Appends one graph to the open level. parent indexes the previous level and
+ * bit v of mask is set when the new vertex (n - 1) is attached to parent vertex v. */
+int treecat_append(treecat_writer_t *writer, long parent, uint64_t mask) {
+    treecat_block_header_t *block = &writer->block;
+    unsigned char record[16];
+
+    block->count++;
+    if (block->n == TREECAT_ROOTN) {
+        return 0;
+    }
+    put_bytes(record, (uint64_t) parent, block->parent_bytes);
+    put_bytes(record + block->parent_bytes, mask, block->mask_bytes);
+    if (fwrite(record, block->parent_bytes + block->mask_bytes, 1, writer->out) != 1) {
+        IGRAPH_ERROR("Write error", IGRAPH_EFILE);
+    }
+    return 0;
+}
+
+/* Closes the open level by patching its record count into the block header. */
+int treecat_end_level(treecat_writer_t *writer) {
+    long end = ftell(writer->out);
+
+    if (fseek(writer->out, writer->block_offset, SEEK_SET) != 0 ||
+        fwrite(&writer->block, sizeof(writer->block), 1, writer->out) != 1 ||
+        fseek(writer->out, end, SEEK_SET) != 0) {
+        IGRAPH_ERROR("Write error", IGRAPH_EFILE);
+    }
+    writer->prev_count = (long) writer->block.count;
+    return 0;
+}
+
+/* Writes a complete level at once; the root level (n == TREECAT_ROOTN)
+ * takes NULL arrays. */
+int treecat_write_level(treecat_writer_t *writer, int n, long count,
+                        const long *parents, const uint64_t *masks) {
+    IGRAPH_CHECK(treecat_begin_level(writer, n));
+    for (long i = 0; i < count; i++) {
+        IGRAPH_CHECK(treecat_append(writer, parents ? parents[i] : 0, masks ? masks[i] : 0));
+    }
+    return treecat_end_level(writer);
+}
+
+int treecat_writer_close(treecat_writer_t *writer) {
+    if (fclose(writer->out) != 0) {
+        IGRAPH_ERROR("Write error", IGRAPH_EFILE);
+    }
+    writer->out = NULL;
+    return 0;
+}
+
+static void cache_init(treecat_cache_t *cache, long capacity) {
+    memset(cache, 0, sizeof(*cache));
+    cache->capacity = capacity;
+    if (capacity > 0) {
+        cache->nbuckets = 1;
+        while (cache->nbuckets < 2 * capacity) {
+            cache->nbuckets <<= 1;
+        }
+        cache->buckets = calloc(cache->nbuckets, sizeof(treecat_entry_t *));
+    }
+}
+
+static void cache_destroy(treecat_cache_t *cache) {
+    treecat_entry_t *e = cache->head;
+    while (e != NULL) {
+        treecat_entry_t *next = e->next;
+        free(e);
+        e = next;
+    }
+    free(cache->buckets);
+    memset(cache, 0, sizeof(*cache));
+}
+
+static inline long cache_bucket(const treecat_cache_t *cache, int n, long id) {
+    uint64_t h = ((uint64_t) id << 7 | (uint64_t) n) * 0x9e3779b97f4a7c15ULL;
+    return (long) (h >> 20) & (cache->nbuckets - 1);
+}
+
+static void cache_unlink(treecat_cache_t *cache, treecat_entry_t *e) {
+    if (e->prev) e->prev->next = e->next; else cache->head = e->next;
+    if (e->next) e->next->prev = e->prev; else cache->tail = e->prev;
+    e->prev = e->next = NULL;
+}
+
+static void cache_push_front(treecat_cache_t *cache, treecat_entry_t *e) {
+    e->prev = NULL;
+    e->next = cache->head;
+    if (cache->head) cache->head->prev = e; else cache->tail = e;
+    cache->head = e;
+}
+
+static treecat_entry_t *cache_get(treecat_cache_t *cache, int n, long id) {
+    if (cache->capacity == 0) {
+        return NULL;
+    }
+    for (treecat_entry_t *e = cache->buckets[cache_bucket(cache, n, id)]; e; e = e->chain) {
+        if (e->n == n && e->id == id) {
+            cache_unlink(cache, e);
+            cache_push_front(cache, e);
+            cache->hits++;
+            return e;
+        }
+    }
+    cache->misses++;
+    return NULL;
+}
+
+static void cache_put(treecat_cache_t *cache, int n, long id, const uint64_t *rows) {
+    treecat_entry_t *e, **link;
+
+    if (cache->capacity == 0) {
+        return;
+    }
+    if (cache->size == cache->capacity) {
+        // evict the least recently used entry and reuse its storage
+        e = cache->tail;
+        cache_unlink(cache, e);
+        for (link = &cache->buckets[cache_bucket(cache, e->n, e->id)]; *link != e; link = &(*link)->chain);
+        *link = e->chain;
+    } else {
+        e = malloc(sizeof(treecat_entry_t));
+        cache->size++;
+    }
+    e->n = n;
+    e->id = id;
+    memcpy(e->rows, rows, n * sizeof(uint64_t));
+    link = &cache->buckets[cache_bucket(cache, n, id)];
+    e->chain = *link;
+    *link = e;
+    cache_push_front(cache, e);
+}
+
+int treecat_open(treecat_t *catalog, const char *path, long cache_capacity) {
+    struct stat st;
+    const treecat_file_header_t *header;
+    size_t offset;
+    int fd = open(path, O_RDONLY);
+
+    memset(catalog, 0, sizeof(*catalog));
+    if (fd < 0) {
+        IGRAPH_ERROR("Cannot open tree catalog", IGRAPH_EFILE);
+    }
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(treecat_file_header_t)) {
+        close(fd);
+        IGRAPH_ERROR("Tree catalog is truncated", IGRAPH_EFILE);
+    }
+    catalog->size = st.st_size;
+    catalog->map = mmap(NULL, catalog->size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (catalog->map == MAP_FAILED) {
+        catalog->map = NULL;
+        IGRAPH_ERROR("Cannot map tree catalog", IGRAPH_EFILE);
+    }
+
+    header = catalog->map;
+    if (memcmp(header->magic, TREECAT_MAGIC, 8) != 0 || header->version != TREECAT_VERSION ||
+        header->root_n != TREECAT_ROOTN) {
+        treecat_close(catalog);
+        IGRAPH_ERROR("Not a graham tree catalog", IGRAPH_PARSEERROR);
+    }
+    offset = sizeof(*header);
+    while (offset + sizeof(treecat_block_header_t) <= catalog->size) {
+        treecat_block_header_t block;
+        memcpy(&block, (const char *) catalog->map + offset, sizeof(block));
+        offset += sizeof(block);
+        if (block.n > TREECAT_MAXN ||
+            offset + block.count * (block.parent_bytes + block.mask_bytes) > catalog->size) {
+            treecat_close(catalog);
+            IGRAPH_ERROR("Corrupt tree catalog block", IGRAPH_PARSEERROR);
+        }
+        catalog->levels[block.n].count = (long) block.count;
+        catalog->levels[block.n].parent_bytes = block.parent_bytes;
+        catalog->levels[block.n].mask_bytes = block.mask_bytes;
+        catalog->levels[block.n].records = (const unsigned char *) catalog->map + offset;
+        catalog->maxn = block.n;
+        offset += block.count * (block.parent_bytes + block.mask_bytes);
+    }
+    cache_init(&catalog->cache, cache_capacity);
+    return 0;
+}
+
+void treecat_close(treecat_t *catalog) {
+    if (catalog->map != NULL) {
+        munmap(catalog->map, catalog->size);
+    }
+    cache_destroy(&catalog->cache);
+    memset(catalog, 0, sizeof(*catalog));
+}
+
+long treecat_count(const treecat_t *catalog, int n) {
+    return (n >= 0 && n <= TREECAT_MAXN) ? catalog->levels[n].count : 0;
+}
+
+int treecat_record(const treecat_t *catalog, int n, long id, long *parent, uint64_t *mask) {
+    const treecat_level_t *level;
+
+    if (n <= TREECAT_ROOTN || n > catalog->maxn || id < 0 || id >= catalog->levels[n].count) {
+        IGRAPH_ERROR("No such graph in tree catalog", IGRAPH_EINVAL);
+    }
+    level = &catalog->levels[n];
+    const unsigned char *record = level->records + id * (level->parent_bytes + level->mask_bytes);
+    *parent = (long) get_bytes(record, level->parent_bytes);
+    *mask = get_bytes(record + level->parent_bytes, level->mask_bytes);
+    return 0;
+}
+
+/* Rebuilds graph (n, id) as adjacency bit rows (rows[v] bit u = edge u-v).
+ * Walks parent pointers until the root or a cached ancestor, then replays the
+ * attachments downwards, caching each ancestor on the way. */
+int treecat_rows(treecat_t *catalog, int n, long id, uint64_t *rows) {
+    long ids[TREECAT_MAXN + 1];
+    uint64_t masks[TREECAT_MAXN + 1];
+    treecat_entry_t *cached = NULL;
+    int k = n;
+
+    if (n < TREECAT_ROOTN || n > catalog->maxn || id < 0 || id >= catalog->levels[n].count) {
+        IGRAPH_ERROR("No such graph in tree catalog", IGRAPH_EINVAL);
+    }
+    ids[k] = id;
+    while (k > TREECAT_ROOTN) {
+        if (k < n && (cached = cache_get(&catalog->cache, k, ids[k])) != NULL) {
+            break;
+        }
+        IGRAPH_CHECK(treecat_record(catalog, k, ids[k], &ids[k - 1], &masks[k]));
+        k--;
+    }
+
+    memset(rows, 0, n * sizeof(uint64_t));
+    if (cached != NULL) {
+        memcpy(rows, cached->rows, k * sizeof(uint64_t));
+    } else {
+        rows[0] = 1ULL << 1;
+        rows[1] = 1ULL << 0;
+    }
+    for (k++; k <= n; k++) {
+        int v = k - 1;
+        rows[v] = masks[k];
+        for (uint64_t m = masks[k]; m; m &= m - 1) {
+            rows[__builtin_ctzll(m)] |= 1ULL << v;
+        }
+        if (k < n) {
+            cache_put(&catalog->cache, k, ids[k], rows);
+        }
+    }
+    return 0;
+}
+
+/* Rebuilds graph (n, id) with the vertex labels it had when it was generated. */
+int treecat_graph(treecat_t *catalog, int n, long id, igraph_t *graph) {
+    uint64_t rows[TREECAT_MAXN];
+    igraph_vector_t edges;
+
+    IGRAPH_CHECK(treecat_rows(catalog, n, id, rows));
+    IGRAPH_CHECK(igraph_vector_init(&edges, 0));
+    for (int u = 0; u < n; u++) {
+        for (uint64_t m = rows[u] >> u; m; m &= m - 1) {
+            igraph_vector_push_back(&edges, u);
+            igraph_vector_push_back(&edges, u + __builtin_ctzll(m));
+        }
+    }
+    igraph_create(graph, &edges, n, IGRAPH_UNDIRECTED);
+    igraph_vector_destroy(&edges);
+    return 0;
+}
@@ -0,0 +1,83 @@
+//
+// Tree-encoded catalog: every graph of level N is stored as the pair
+// (ID of its parent seed at level N-1, mask of parent vertices the new
+// vertex attaches to). Graphs are rebuilt by walking parent pointers.
+//
+
+#ifndef GRAHAM_TREECAT_H
+#define GRAHAM_TREECAT_H
+
+#include <igraph/igraph.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define TREECAT_MAXN 64
+#define TREECAT_ROOTN 2
+#define TREECAT_MAGIC "GRHMTRE1"
+#define TREECAT_VERSION 1
+
+/* On-disk layout: treecat_file_header_t, then one block per level in
+ * increasing N. A block is a treecat_block_header_t followed by count
+ * records of parent_bytes + mask_bytes little-endian bytes each. */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t root_n;
+} treecat_file_header_t;
+
+typedef struct {
+    uint32_t n;
+    uint32_t parent_bytes;
+    uint32_t mask_bytes;
+    uint32_t reserved;
+    uint64_t count;
+} treecat_block_header_t;
+
+typedef struct {
+    FILE *out;
+    long prev_count;
+    long block_offset;              // file position of the open level's header
+    treecat_block_header_t block;   // header of the level being appended to
+} treecat_writer_t;
+
+typedef struct {
+    long count;
+    int parent_bytes;
+    int mask_bytes;
+    const unsigned char *records;
+} treecat_level_t;
+
+typedef struct treecat_entry treecat_entry_t;
+
+/* LRU cache of reconstructed ancestors (adjacency bit rows). Not thread safe. */
+typedef struct {
+    treecat_entry_t **buckets;
+    treecat_entry_t *head, *tail;
+    long size, capacity, nbuckets;
+    long hits, misses;
+} treecat_cache_t;
+
+typedef struct {
+    void *map;
+    size_t size;
+    int maxn;
+    treecat_level_t levels[TREECAT_MAXN + 1];
+    treecat_cache_t cache;
+} treecat_t;
+
+int treecat_writer_open(treecat_writer_t *writer, const char *path);
+int treecat_begin_level(treecat_writer_t *writer, int n);
+int treecat_append(treecat_writer_t *writer, long parent, uint64_t mask);
+int treecat_end_level(treecat_writer_t *writer);
+int treecat_write_level(treecat_writer_t *writer, int n, long count,
+                        const long *parents, const uint64_t *masks);
+int treecat_writer_close(treecat_writer_t *writer);
+
+int treecat_open(treecat_t *catalog, const char *path, long cache_capacity);
+void treecat_close(treecat_t *catalog);
+long treecat_count(const treecat_t *catalog, int n);
+int treecat_record(const treecat_t *catalog, int n, long id, long *parent, uint64_t *mask);
+int treecat_rows(treecat_t *catalog, int n, long id, uint64_t *rows);
+int treecat_graph(treecat_t *catalog, int n, long id, igraph_t *graph);
+
+#endif //GRAHAM_TREECAT_H
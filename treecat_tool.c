@@ -0,0 +1,69 @@
+//
+// Command line front end for tree-encoded catalogs.
+//
+//   treecat info   <catalog.tree>
+//   treecat expand <catalog.tree> [N]      (prints graphs like nonisomorphic.txt)
+//   treecat get    <catalog.tree> <N> <id>
+//
+
+#include "treecat.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define CACHE_CAPACITY 4096
+
+static void usage(void) {
+    fprintf(stderr, "usage: treecat info <catalog.tree>\n"
+                    "       treecat expand <catalog.tree> [N]\n"
+                    "       treecat get <catalog.tree> <N> <id>\n");
+}
+
+/* Prints graph (n, id) in the same edge list format as write_graph */
+static int print_graph(treecat_t *catalog, int n, long id) {
+    uint64_t rows[TREECAT_MAXN];
+    if (treecat_rows(catalog, n, id, rows) != 0) {
+        return 1;
+    }
+    printf("\n");
+    for (int u = 0; u < n; u++) {
+        for (uint64_t m = rows[u] >> u; m; m &= m - 1) {
+            printf("%i %i ", u, u + __builtin_ctzll(m));
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    treecat_t catalog;
+    int ret = 0;
+
+    if (argc < 3 || treecat_open(&catalog, argv[2], CACHE_CAPACITY) != 0) {
+        usage();
+        return 2;
+    }
+    if (strcmp(argv[1], "info") == 0) {
+        printf("%10s %10s %10s\n", "N", "count", "bytes/rec");
+        for (int n = TREECAT_ROOTN; n <= catalog.maxn; n++) {
+            printf("%10i %10li %10i\n", n, treecat_count(&catalog, n),
+                   catalog.levels[n].parent_bytes + catalog.levels[n].mask_bytes);
+        }
+        printf("%lu bytes\n", (unsigned long) catalog.size);
+    } else if (strcmp(argv[1], "expand") == 0) {
+        int from = argc > 3 ? atoi(argv[3]) : TREECAT_ROOTN;
+        int to = argc > 3 ? from : catalog.maxn;
+        for (int n = from; n <= to && ret == 0; n++) {
+            for (long id = 0; id < treecat_count(&catalog, n) && ret == 0; id++) {
+                ret = print_graph(&catalog, n, id);
+            }
+        }
+        fprintf(stderr, "ancestor cache: %li hits, %li misses\n", catalog.cache.hits, catalog.cache.misses);
+    } else if (strcmp(argv[1], "get") == 0 && argc == 5) {
+        ret = print_graph(&catalog, atoi(argv[3]), atol(argv[4]));
+        printf("\n");
+    } else {
+        usage();
+        ret = 2;
+    }
+    treecat_close(&catalog);
+    return ret;
+}
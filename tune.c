@@ -0,0 +1,213 @@
+//
+// Autotuning of the filter phase: OpenMP schedule and chunk, canonical batch
+// size and incremental refinement, bliss splitting heuristic. Timed on the
+// small levels and saved per machine so later runs can skip the search.
+//
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "graham.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <omp.h>
+
+// runs per configuration; the fastest one counts
+#define TUNE_REPEATS 3
+
+typedef enum {
+    TUNE_SCHEDULE,
+    TUNE_CHUNK,
+    TUNE_BATCH,         // canonical engine only
+    TUNE_INCREMENTAL,   // canonical engine only
+    TUNE_BLISS_SH,      // pairwise engine only
+    TUNE_NDIMS
+} tune_dim_t;
+
+static const char *schedule_names[] = {"static", "dynamic", "guided"};
+
+static const struct {
+    int engine;         // -1 for both engines
+    int nvalues;
+    int values[8];
+} dims[TUNE_NDIMS] = {
+    {-1, 3, {GRAHAM_SCHEDULE_STATIC, GRAHAM_SCHEDULE_DYNAMIC, GRAHAM_SCHEDULE_GUIDED}},
+    {-1, 5, {0, 1, 4, 16, 64}},
+    {GRAHAM_ENGINE_CANONICAL, 6, {8, 16, 32, 64, 128, 256}},
+    {GRAHAM_ENGINE_CANONICAL, 2, {1, 0}},
+    {GRAHAM_ENGINE_PAIRWISE, 6, {IGRAPH_BLISS_F, IGRAPH_BLISS_FL, IGRAPH_BLISS_FS,
+                                 IGRAPH_BLISS_FM, IGRAPH_BLISS_FLM, IGRAPH_BLISS_FSM}},
+};
+
+static void set_dim(graham_config_t *config, tune_dim_t dim, int value) {
+    switch (dim) {
+        case TUNE_SCHEDULE: config->schedule = (graham_schedule_t) value; break;
+        case TUNE_CHUNK: config->chunk = value; break;
+        case TUNE_BATCH: config->batch = value; break;
+        case TUNE_INCREMENTAL: config->incremental = value; break;
+        case TUNE_BLISS_SH: config->bliss_sh = (igraph_bliss_sh_t) value; break;
+        default: break;
+    }
+}
+
+static int get_dim(const graham_config_t *config, tune_dim_t dim) {
+    switch (dim) {
+        case TUNE_SCHEDULE: return config->schedule;
+        case TUNE_CHUNK: return config->chunk;
+        case TUNE_BATCH: return config->batch;
+        case TUNE_INCREMENTAL: return config->incremental;
+        case TUNE_BLISS_SH: return config->bliss_sh;
+        default: return 0;
+    }
+}
+
+/* Fastest of TUNE_REPEATS complete runs up to config->maxn, nothing written */
+static double measure(const graham_config_t *config) {
+    double best = 0;
+    for (int r = 0; r < TUNE_REPEATS; r++) {
+        double start = omp_get_wtime();
+        graham_enumerate(config, NULL, NULL, NULL);
+        double time = omp_get_wtime() - start;
+        best = r == 0 || time < best ? time : best;
+    }
+    return best;
+}
+
+/* Searches one dimension at a time (schedule, chunk, then the engine's own
+ * knobs), keeping each setting that beats the best time so far, on a run up
+ * to tune_n (0 picks 6 for the pairwise engine and 8 for the canonical one,
+ * never above config->maxn). tuned is config with the winners applied. */
+int graham_autotune(const graham_config_t *config, int tune_n, graham_config_t *tuned) {
+    graham_config_t trial;
+
+    IGRAPH_CHECK(graham_config_check(config));
+    if (tune_n == 0) {
+        tune_n = config->engine == GRAHAM_ENGINE_PAIRWISE ? 6 : 8;
+    }
+    tune_n = tune_n < config->maxn ? tune_n : config->maxn;
+    tune_n = tune_n > 2 ? tune_n : 2;
+
+    *tuned = *config;
+    trial = *config;
+    trial.maxn = tune_n;
+    trial.counters = 0;
+    double best = measure(&trial);
+    for (int dim = 0; dim < TUNE_NDIMS; dim++) {
+        if (dims[dim].engine >= 0 && dims[dim].engine != (int) config->engine) {
+            continue;
+        }
+        int winner = get_dim(&trial, dim);
+        for (int i = 0; i < dims[dim].nvalues; i++) {
+            if (dims[dim].values[i] == winner) {
+                continue;
+            }
+            int previous = get_dim(&trial, dim);
+            set_dim(&trial, dim, dims[dim].values[i]);
+            double time = measure(&trial);
+            if (time < best) {
+                best = time;
+                winner = dims[dim].values[i];
+            }
+            set_dim(&trial, dim, previous);
+        }
+        set_dim(&trial, dim, winner);
+        set_dim(tuned, dim, winner);
+    }
+    return 0;
+}
+
+/* CPU model, online CPUs and team size: a tuning file only applies to the
+ * machine and thread count it was measured with. */
+static void hardware_key(const graham_config_t *config, char *key, size_t size) {
+    char model[256] = "unknown", *line = NULL;
+    size_t length = 0;
+    FILE *cpuinfo = fopen("/proc/cpuinfo", "r");
+
+    while (cpuinfo != NULL && getline(&line, &length, cpuinfo) != -1) {
+        char *colon = strchr(line, ':');
+        if (strncmp(line, "model name", 10) == 0 && colon != NULL) {
+            snprintf(model, sizeof(model), "%s", colon + 2);
+            model[strcspn(model, "\n")] = '\0';
+            break;
+        }
+    }
+    free(line);
+    if (cpuinfo != NULL) {
+        fclose(cpuinfo);
+    }
+    int threads = config->threads > 0 ? config->threads : omp_get_max_threads();
+    snprintf(key, size, "%s, %li cpus, %i threads", model, sysconf(_SC_NPROCESSORS_ONLN), threads);
+}
+
+int graham_tuning_save(const graham_config_t *config, const char *path) {
+    char key[512];
+    FILE *out = fopen(path, "w");
+
+    if (out == NULL) {
+        IGRAPH_ERROR("Cannot open tuning file", IGRAPH_EFILE);
+    }
+    hardware_key(config, key, sizeof(key));
+    fprintf(out, "# graham tuning file\n");
+    fprintf(out, "hardware %s\n", key);
+    fprintf(out, "engine %i\n", config->engine);
+    fprintf(out, "schedule %s\n", schedule_names[config->schedule]);
+    fprintf(out, "chunk %i\n", config->chunk);
+    fprintf(out, "batch %i\n", config->batch);
+    fprintf(out, "incremental %i\n", config->incremental);
+    fprintf(out, "bliss_sh %i\n", config->bliss_sh);
+    if (fclose(out) != 0) {
+        IGRAPH_ERROR("Write error", IGRAPH_EFILE);
+    }
+    return 0;
+}
+
+/* Applies a tuning file written by graham_tuning_save on this machine for
+ * config's engine and thread count. Returns 0 when applied and 1 (config
+ * untouched) when the file is missing or was tuned for something else. */
+int graham_tuning_load(graham_config_t *config, const char *path) {
+    char key[512], *line = NULL;
+    size_t length = 0;
+    int matched = 0, engine = -1;
+    graham_config_t tuned = *config;
+    FILE *in = fopen(path, "r");
+
+    if (in == NULL) {
+        return 1;
+    }
+    hardware_key(config, key, sizeof(key));
+    while (getline(&line, &length, in) != -1) {
+        char *value = strchr(line, ' ');
+        if (line[0] == '#' || value == NULL) {
+            continue;
+        }
+        *value++ = '\0';
+        value[strcspn(value, "\n")] = '\0';
+        if (strcmp(line, "hardware") == 0) {
+            matched = strcmp(value, key) == 0;
+        } else if (strcmp(line, "engine") == 0) {
+            engine = atoi(value);
+        } else if (strcmp(line, "schedule") == 0) {
+            for (int s = 0; s < 3; s++) {
+                if (strcmp(value, schedule_names[s]) == 0) {
+                    tuned.schedule = (graham_schedule_t) s;
+                }
+            }
+        } else if (strcmp(line, "chunk") == 0) {
+            tuned.chunk = atoi(value);
+        } else if (strcmp(line, "batch") == 0) {
+            tuned.batch = atoi(value);
+        } else if (strcmp(line, "incremental") == 0) {
+            tuned.incremental = atoi(value);
+        } else if (strcmp(line, "bliss_sh") == 0) {
+            tuned.bliss_sh = (igraph_bliss_sh_t) atoi(value);
+        }
+    }
+    free(line);
+    fclose(in);
+    if (!matched || engine != (int) config->engine || tuned.chunk < 0 || tuned.batch < 1
+        || tuned.bliss_sh < IGRAPH_BLISS_F || tuned.bliss_sh > IGRAPH_BLISS_FSM) {
+        return 1;
+    }
+    *config = tuned;
+    return 0;
+}